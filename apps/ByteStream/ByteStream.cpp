@@ -0,0 +1,79 @@
+#include <NoCL.h>
+
+// Kernel for streaming through a vector of narrow elements
+// (Used to measure effective load bandwidth for each element type)
+template <typename T> struct ByteStream : Kernel {
+  int len;
+  T* in;
+  unsigned* sums;
+
+  void kernel() {
+    unsigned sum = 0;
+    for (int i = threadIdx.x; i < len; i += blockDim.x)
+      sum += in[i];
+    sums[threadIdx.x] = sum;
+  }
+};
+
+// Stream through given number of bytes using elements of type T
+template <typename T> bool streamAs(void* data, int numBytes,
+                                    unsigned* sums) {
+  // Instantiate kernel
+  ByteStream<T> k;
+
+  // Use a single block of threads
+  k.blockDim.x = SIMTWarps * SIMTLanes;
+
+  // Assign parameters
+  k.len = numBytes / sizeof(T);
+  k.in = (T*) data;
+  k.sums = sums;
+
+  // Invoke kernel
+  puts("Bytes: "); puthex(numBytes); putchar('\n');
+  noclRunKernelAndDumpStats(&k);
+
+  // Check result
+  bool ok = true;
+  for (int t = 0; t < k.blockDim.x; t++) {
+    unsigned sum = 0;
+    for (int i = t; i < k.len; i += k.blockDim.x)
+      sum += k.in[i];
+    ok = ok && sums[t] == sum;
+  }
+  return ok;
+}
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Vector size (in bytes) for benchmarking
+  int N = isSim ? 8192 : 1048576;
+
+  // Input and output vectors
+  nocl_aligned unsigned char data[N];
+  nocl_aligned unsigned sums[SIMTWarps * SIMTLanes];
+
+  // Initialise inputs
+  for (int i = 0; i < N; i++)
+    data[i] = i & 0xff;
+
+  // Same data, viewed as 8-bit, 16-bit and 32-bit elements
+  // (Effective bandwidth is Bytes / Cycles for each)
+  bool ok = true;
+  puts("8-bit elements\n");
+  ok = streamAs<uint8_t>(data, N, sums) && ok;
+  puts("16-bit elements\n");
+  ok = streamAs<uint16_t>(data, N, sums) && ok;
+  puts("32-bit elements\n");
+  ok = streamAs<uint32_t>(data, N, sums) && ok;
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
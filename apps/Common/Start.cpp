@@ -1,4 +1,5 @@
 #include <Config.h>
+#include <DMA.h>
 #include <Pebbles/CSRs/UART.h>
 
 #if EnableCHERI
@@ -9,6 +10,9 @@
 extern "C" void _start();
 extern int main();
 
+// Bounds of .bss section (see link.ld.h)
+extern uint8_t __bss_start[], __bss_end[];
+
 // Send byte over UART (blocking)
 INLINE void putByte(uint32_t byte)
 {
@@ -26,6 +30,19 @@ void _start()
     cheri_init_globals_3(almighty, almighty, almighty);
   #endif
 
+  // Zero .bss (which is not part of the image sent by the host)
+  // (Using the DMA engine for the beat-aligned part, if present)
+  #if EnableDMA
+    unsigned bssBytes = __bss_end - __bss_start, offset, beatBytes;
+    noclDMASplit(__bss_start, bssBytes, &offset, &beatBytes);
+    if (beatBytes > 0) noclDMAFill(__bss_start + offset, beatBytes, 0);
+    for (unsigned i = 0; i < offset; i++) __bss_start[i] = 0;
+    for (unsigned i = offset + beatBytes; i < bssBytes; i++)
+      __bss_start[i] = 0;
+  #else
+    for (uint8_t* p = __bss_start; p != __bss_end; p++) *p = 0;
+  #endif
+
   // Invoke application
   main();
 
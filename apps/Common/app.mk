@@ -20,6 +20,27 @@ else
   RV_ABI = ilp32
 endif
 
+# Bit-manipulation extensions (Zba and Zbb)
+ZB_EN ?= $(shell echo -n EnableZb \
+              | cpp -P -imacros $(CONFIG_H) - | xargs)
+ifeq ($(ZB_EN), 1)
+  RV_ARCH := $(RV_ARCH)_zba_zbb
+endif
+
+# Integer conditional operations extension (Zicond)
+ZICOND_EN ?= $(shell echo -n EnableZicond \
+              | cpp -P -imacros $(CONFIG_H) - | xargs)
+ifeq ($(ZICOND_EN), 1)
+  RV_ARCH := $(RV_ARCH)_zicond
+endif
+
+# Single-precision floating point in integer registers (Zfinx)
+ZFINX_EN ?= $(shell echo -n EnableZfinx \
+              | cpp -P -imacros $(CONFIG_H) - | xargs)
+ifeq ($(ZFINX_EN), 1)
+  RV_ARCH := $(RV_ARCH)_zfinx
+endif
+
 ifeq ($(USE_CLANG), 1)
 CFLAGS     = -fuse-ld=lld -g
 RV_CC      = riscv64-unknown-freebsd-clang++
@@ -53,11 +74,10 @@ code.v: app.elf
 	$(RV_OBJCOPY) -O verilog --only-section=.text app.elf code.v
 
 data.v: app.elf
-	$(RV_OBJCOPY) -O verilog --remove-section=.text \
-                --set-section-flags .bss=alloc,load,contents app.elf data.v
+	$(RV_OBJCOPY) -O verilog --remove-section=.text app.elf data.v
 
 app.elf: link.ld $(CFILES)
-	$(RV_CC) $(CFLAGS) -T link.ld -o app.elf $(CFILES)
+	$(RV_CC) $(CFLAGS) -T link.ld -o app.elf $(CFILES) $(APP_LIBS)
 
 link.ld: ../Common/link.ld.h
 	cpp -P -I $(SIMTIGHT_ROOT)/inc $< > link.ld
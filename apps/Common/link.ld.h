@@ -16,7 +16,7 @@ MEMORY
 SECTIONS
 {
   .text   : { *.o(.text*) }             > instrs
-  .bss    : { *.o(.bss*) }              > globals = 0
+  .bss    : { __bss_start = .; *.o(.bss*) __bss_end = .; } > globals
   .rodata : { *.o(.rodata*) }           > globals
   .sdata  : { *.o(.sdata*) }            > globals
   .data   : { *.o(.data*) }             > globals
@@ -0,0 +1,97 @@
+#include <NoCL.h>
+#include <Rand.h>
+
+// Quantised (int8) fully-connected layer: out = W * in, where W has
+// one row of int8 weights per output.  Each thread computes one output.
+// Weights are stored word-interleaved (word j of every row, then word
+// j+1 of every row, ...) so that accesses by a warp are coalesced.
+template <bool Packed> struct DotProd8 : Kernel {
+  int numOutputs, numWords;
+  uint32_t *weights, *in;
+  int *out;
+
+  void kernel() {
+    for (int i = threadIdx.x; i < numOutputs; i += blockDim.x) {
+      int sum = 0;
+      for (int j = 0; j < numWords; j++) {
+        uint32_t w = weights[j * numOutputs + i];
+        uint32_t x = in[j];
+        if (Packed) {
+          // One instruction per four elements
+          sum = noclDot8(w, x, sum);
+        }
+        else {
+          // One element at a time
+          for (int k = 0; k < 32; k += 8)
+            sum += (int) (int8_t) (w >> k) * (int) (int8_t) (x >> k);
+        }
+      }
+      out[i] = sum;
+    }
+  }
+};
+
+// Run kernel and check result
+template <bool Packed> bool run(int numOutputs, int numWords,
+                                uint32_t* weights, uint32_t* in, int* out) {
+  // Instantiate kernel
+  DotProd8<Packed> k;
+
+  // Use single block of threads
+  k.blockDim.x = SIMTLanes * SIMTWarps;
+
+  // Assign parameters
+  k.numOutputs = numOutputs;
+  k.numWords = numWords;
+  k.weights = weights;
+  k.in = in;
+  k.out = out;
+
+  // Invoke kernel
+  noclRunKernelAndDumpStats(&k);
+
+  // Check result
+  bool ok = true;
+  for (int i = 0; i < numOutputs; i++) {
+    int sum = 0;
+    for (int j = 0; j < numWords; j++)
+      for (int b = 0; b < 32; b += 8)
+        sum += (int) (int8_t) (weights[j * numOutputs + i] >> b) *
+               (int) (int8_t) (in[j] >> b);
+    ok = ok && out[i] == sum;
+  }
+  return ok;
+}
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Layer size for benchmarking (inputs are a multiple of 4)
+  int numOutputs = isSim ? 256 : 4096;
+  int numInputs = isSim ? 64 : 1024;
+  int numWords = numInputs / 4;
+
+  // Packed weights, inputs, and outputs
+  nocl_aligned uint32_t weights[numWords * numOutputs];
+  nocl_aligned uint32_t in[numWords];
+  nocl_aligned int out[numOutputs];
+
+  // Initialise inputs (in parallel, on the SIMT core)
+  randFill(weights, numWords * numOutputs, 1);
+  randFill(in, numWords, 2);
+
+  // Compare element-at-a-time and packed versions
+  puts("Unpacked\n");
+  bool ok = run<false>(numOutputs, numWords, weights, in, out);
+  puts("Packed\n");
+  ok = run<true>(numOutputs, numWords, weights, in, out) && ok;
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <NoCL.h>
+
+// Transpose a matrix whose width is not a power of two, with one
+// thread per element computing its row and column from a flat index.
+// Compares plain division (using the divider) against FastDivisor
+// (using a multiply-high and shifts).
+template <typename Divisor> struct FlatTranspose : Kernel {
+  unsigned len, height;
+  Divisor width;
+  int *in, *out;
+
+  void kernel() {
+    for (unsigned i = threadIdx.x; i < len; i += blockDim.x) {
+      unsigned row = i / width;
+      unsigned col = i % width;
+      out[col * height + row] = in[i];
+    }
+  }
+};
+
+// Run kernel and check result
+template <typename Divisor> bool run(int width, int height,
+                                     int* in, int* out) {
+  // Instantiate kernel
+  FlatTranspose<Divisor> k;
+
+  // Use single block of threads
+  k.blockDim.x = SIMTLanes * SIMTWarps;
+
+  // Assign parameters
+  k.len = width * height;
+  k.height = height;
+  k.width = width;
+  k.in = in;
+  k.out = out;
+
+  // Invoke kernel
+  noclRunKernelAndDumpStats(&k);
+
+  // Check result
+  bool ok = true;
+  for (int i = 0; i < height; i++)
+    for (int j = 0; j < width; j++)
+      ok = ok && out[j * height + i] == in[i * width + j];
+  return ok;
+}
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Matrix size for benchmarking (width deliberately not a power of 2)
+  int width = isSim ? 100 : 1000;
+  int height = isSim ? 64 : 1024;
+
+  // Input and output matrices
+  nocl_aligned int in[width * height];
+  nocl_aligned int out[width * height];
+
+  // Initialise inputs (on the SIMT core)
+  noclIota(in, width * height);
+
+  // Compare plain division and FastDivisor
+  puts("Plain division\n");
+  bool ok = run<unsigned>(width, height, in, out);
+  for (int i = 0; i < width * height; i++) out[i] = 0;
+  puts("FastDivisor\n");
+  ok = run<FastDivisor>(width, height, in, out) && ok;
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+#include <NoCL.h>
+#include <Rand.h>
+#include <FixedPoint.h>
+
+// Apply a fixed-point function to each element of a vector
+template <fix16_t (*F)(fix16_t)> struct FixMap : Kernel {
+  int len;
+  fix16_t *in, *out;
+
+  void kernel() {
+    for (int i = threadIdx.x; i < len; i += blockDim.x)
+      out[i] = F(in[i]);
+  }
+};
+
+// Reference implementations, in double precision on the CPU
+// =========================================================
+
+const double ln2 = 0.6931471805599453;
+const double pi = 3.141592653589793;
+
+double toDouble(fix16_t x) { return (double) x / 65536.0; }
+
+double refExp(double x) {
+  // e^x = 2^k e^r, with |r| <= ln(2)/2
+  int k = (int) (x / ln2 + (x < 0 ? -0.5 : 0.5));
+  double r = x - k * ln2;
+  double sum = 1.0, term = 1.0;
+  for (int i = 1; i < 16; i++) { term = term * r / i; sum += term; }
+  for (; k > 0; k--) sum *= 2.0;
+  for (; k < 0; k++) sum *= 0.5;
+  return sum;
+}
+
+double refLog(double x) {
+  // ln(x) = k ln(2) + 2 atanh((m-1)/(m+1)), with m in [1, 2)
+  int k = 0;
+  while (x >= 2.0) { x *= 0.5; k++; }
+  while (x < 1.0) { x *= 2.0; k--; }
+  double z = (x - 1.0) / (x + 1.0), z2 = z * z, sum = 0.0, pow = z;
+  for (int i = 1; i < 40; i += 2) { sum += pow / i; pow *= z2; }
+  return k * ln2 + 2.0 * sum;
+}
+
+double refSin(double x) {
+  // Reduce to [-pi, pi], then Taylor series
+  int k = (int) (x / (2 * pi) + (x < 0 ? -0.5 : 0.5));
+  x = x - k * 2 * pi;
+  double sum = 0.0, term = x;
+  for (int i = 1; i < 40; i += 2) { sum += term; term = -term * x * x / ((i+1) * (i+2)); }
+  return sum;
+}
+
+double refCos(double x) { return refSin(x + pi / 2); }
+
+// Error of result in LSBs (relative to the result, for results above one)
+double errorLSBs(fix16_t got, double ref, bool relative) {
+  double err = toDouble(got) - ref;
+  if (err < 0) err = -err;
+  if (ref < 0) ref = -ref;
+  if (relative && ref > 1.0) err = err / ref;
+  return err * 65536.0;
+}
+
+// Run kernel, then measure accuracy on the CPU
+// ============================================
+
+template <fix16_t (*F)(fix16_t)>
+  bool run(const char* name, int len, fix16_t* in, fix16_t* out,
+           int numChecks, double (*ref)(double), bool relative,
+           double maxErr) {
+    puts(name); putchar('\n');
+
+    // Instantiate kernel
+    FixMap<F> k;
+
+    // Use a single block of threads
+    k.blockDim.x = SIMTWarps * SIMTLanes;
+
+    // Assign parameters
+    k.len = len;
+    k.in = in;
+    k.out = out;
+
+    // Invoke kernel
+    noclRunKernelAndDumpStats(&k);
+
+    // Measure error (in 1/256ths of an LSB) over a subset of the outputs
+    double worst = 0.0;
+    for (int i = 0; i < numChecks; i++) {
+      double err = errorLSBs(out[i], ref(toDouble(in[i])), relative);
+      if (err > worst) worst = err;
+    }
+    puts("MaxError (LSB/256): "); puthex((unsigned) (worst * 256.0));
+    putchar('\n');
+    return worst <= maxErr;
+  }
+
+// References for functions with exact results
+double refRecip(double x) { return 1.0 / x; }
+double refSqrt(double x) {
+  // Newton's method from an overestimate
+  double r = x > 1.0 ? x : 1.0;
+  for (int i = 0; i < 40; i++) r = 0.5 * (r + x / r);
+  return r;
+}
+
+// Random inputs in the range [lo, hi), excluding zero
+void init(fix16_t* in, int len, int lo, int hi, uint32_t* seed) {
+  uint32_t range = (uint32_t) (hi - lo) << 16;
+  for (int i = 0; i < len; i++) {
+    uint32_t r = (rand15(seed) << 17) ^ (rand15(seed) << 2) ^ rand15(seed);
+    in[i] = (fix16_t) ((uint32_t) fixFromInt(lo) +
+                         (uint32_t) (((uint64_t) r * range) >> 32));
+    if (in[i] == 0) in[i] = 1;
+  }
+}
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Vector size for benchmarking, and number of outputs checked
+  int N = isSim ? 3000 : 1000000;
+  int numChecks = isSim ? 256 : 4096;
+
+  // Inputs and outputs
+  nocl_aligned fix16_t in[N], out[N];
+
+  bool ok = true;
+  uint32_t seed = 1;
+  init(in, N, -256, 256, &seed);
+  ok = run<fixRecip>("Recip", N, in, out, numChecks, refRecip, false, 1.0)
+         && ok;
+  init(in, N, 0, 32767, &seed);
+  ok = run<fixSqrt>("Sqrt", N, in, out, numChecks, refSqrt, false, 1.0)
+         && ok;
+  init(in, N, -10, 10, &seed);
+  in[0] = 0;
+  ok = run<fixExp>("Exp", N, in, out, numChecks, refExp, true, 1.0) && ok;
+  // e^0 must be exactly one
+  ok = out[0] == FIX16_ONE && ok;
+  init(in, N, 0, 32767, &seed);
+  ok = run<fixLog>("Log", N, in, out, numChecks, refLog, false, 1.0) && ok;
+  init(in, N, -64, 64, &seed);
+  ok = run<fixSin>("Sin", N, in, out, numChecks, refSin, false, 1.0) && ok;
+  ok = run<fixCos>("Cos", N, in, out, numChecks, refCos, false, 1.0) && ok;
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
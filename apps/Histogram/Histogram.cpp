@@ -1,6 +1,8 @@
 #include <NoCL.h>
+#include <Rand.h>
 
-// Kernel for computing 256-bin histograms
+// Kernel for computing 256-bin histograms, using a single set of
+// bins shared by all threads
 struct Histogram : Kernel {
   int len;
   unsigned char* input;
@@ -28,23 +30,18 @@ struct Histogram : Kernel {
   }
 };
 
+// Check histogram against one computed on the CPU
+bool check(int N, unsigned char* input, int* bins) {
+  int expected[256];
+  for (int i = 0; i < 256; i++) expected[i] = 0;
+  for (int i = 0; i < N; i++) expected[input[i]]++;
+  bool ok = true;
+  for (int i = 0; i < 256; i++) ok = ok && bins[i] == expected[i];
+  return ok;
+}
 
-int main()
-{
-  // Are we in simulation?
-  bool isSim = getchar();
-
-  // Vector size for benchmarking
-  int N = isSim ? 3000 : 1000000;
-
-  // Input and output vectors
-  nocl_aligned unsigned char input[N];
-  nocl_aligned int bins[256];
-
-  // Initialise inputs
-  for (int i = 0; i < N; i++)
-    input[i] = i & 0xff;
-
+// Compare shared and privatised versions on given input
+bool run(int N, unsigned char* input, int* bins) {
   // Instantiate kernel
   Histogram k;
 
@@ -57,12 +54,39 @@ int main()
   k.bins = bins;
 
   // Invoke kernel
+  puts("Shared bins\n");
   noclRunKernelAndDumpStats(&k);
+  bool ok = check(N, input, bins);
 
-  // Check result
-  bool ok = true;
-  for (int i = 0; i < 256; i++)
-    ok = ok && bins[i] == (N>>8) + (i < (N&0xff) ? 1 : 0);
+  // Per-warp private bins, over many blocks
+  puts("Private bins\n");
+  noclFill(bins, 256, 0);
+  noclHistogram<256>(input, N, bins, true);
+  return check(N, input, bins) && ok;
+}
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Vector size for benchmarking (a multiple of 4)
+  int N = isSim ? 3000 : 1000000;
+
+  // Input and output vectors
+  nocl_aligned unsigned char input[N];
+  nocl_aligned int bins[256];
+
+  // Uniformly distributed input (in parallel, on the SIMT core)
+  puts("Uniform input\n");
+  randFill((uint32_t*) input, N / 4, 1);
+  bool ok = run(N, input, bins);
+
+  // Highly skewed input: 15 in every 16 values fall in bin 0
+  puts("Skewed input\n");
+  for (int i = 0; i < N; i++)
+    if (i & 15) input[i] = 0;
+  ok = run(N, input, bins) && ok;
 
   // Display result
   puts("Self test: ");
@@ -0,0 +1,207 @@
+#include <NoCL.h>
+#include <Rand.h>
+
+// Integer matrix multiplication C = A * B, one output per thread, using
+// square tiles staged in shared local memory (as in MatMul)
+// (wA is A's width and wB is B's width)
+template <int BlockSize> struct SimpleGEMM : Kernel {
+  int *A, *B, *C;
+  int wA, wB;
+
+  void kernel() {
+    // Tiles of A and B
+    auto As = shared.array<int, BlockSize, BlockSize>();
+    auto Bs = shared.array<int, BlockSize, BlockSize>();
+
+    // Block and thread indices
+    int bx = blockIdx.x, by = blockIdx.y;
+    int tx = threadIdx.x, ty = threadIdx.y;
+
+    // Element of the block's tile of C computed by the thread
+    int Csub = 0;
+
+    for (int k0 = 0; k0 < wA; k0 += BlockSize) {
+      // Each thread loads one element of each tile
+      As[ty][tx] = A[(by * BlockSize + ty) * wA + k0 + tx];
+      Bs[ty][tx] = B[(k0 + ty) * wB + bx * BlockSize + tx];
+      __syncthreads();
+
+      // Two shared loads per multiply-accumulate
+      for (int k = 0; k < BlockSize; k++)
+        Csub = noclMulAdd(As[ty][k], Bs[k][tx], Csub);
+      __syncthreads();
+    }
+
+    // Write the result
+    C[(by * BlockSize + ty) * wB + bx * BlockSize + tx] = Csub;
+  }
+};
+
+// Register-tiled version: the block computes a BM x BN tile of C,
+// stepping through A and B in slices of depth BK, and each thread
+// accumulates a TM x TN sub-tile in registers.  Per step in k, a
+// thread loads TM elements of A and TN of B from shared memory and
+// performs TM x TN multiply-accumulates, rather than two loads per
+// multiply-accumulate.  A thread's rows (columns) are spaced by the
+// number of threads in the y (x) dimension, so the threads of a warp
+// read consecutive columns of B (no bank conflicts) and a few rows of
+// A (served by multicast).
+template <int BM, int BN, int BK, int TM, int TN> struct TiledGEMM : Kernel {
+  int *A, *B, *C;
+  int wA, wB;
+
+  // Tile of C computed by each block
+  static constexpr int TileM = BM;
+  static constexpr int TileN = BN;
+
+  // Thread block dimensions
+  static constexpr int ThreadsX = BN / TN;
+  static constexpr int ThreadsY = BM / TM;
+  static constexpr int Threads = ThreadsX * ThreadsY;
+
+  // Shared memory per block (the banked SRAMs are divided equally
+  // between the blocks resident on a SIMT core)
+  static constexpr int SharedBytes =
+    (4 << (SIMTLogLanes + SIMTLogWordsPerSRAMBank)) /
+      ((SIMTWarps * SIMTLanes) / Threads);
+
+  static_assert((BM * BK + BK * BN) * 4 <= SharedBytes,
+    "TiledGEMM: tiles exceed shared memory budget");
+  static_assert((BM * BK) % Threads == 0 && (BK * BN) % Threads == 0,
+    "TiledGEMM: tile size must be a multiple of block size");
+
+  void kernel() {
+    // Slices of A and B
+    auto As = shared.array<int, BM, BK>();
+    auto Bs = shared.array<int, BK, BN>();
+
+    // Thread indices
+    int tx = threadIdx.x, ty = threadIdx.y;
+    int tid = ty * ThreadsX + tx;
+
+    // Top-left of block's tile of C
+    int row0 = blockIdx.y * BM;
+    int col0 = blockIdx.x * BN;
+
+    // Accumulators
+    int acc[TM][TN];
+    #pragma GCC unroll 16
+    for (int i = 0; i < TM; i++)
+      #pragma GCC unroll 16
+      for (int j = 0; j < TN; j++) acc[i][j] = 0;
+
+    for (int k0 = 0; k0 < wA; k0 += BK) {
+      // Consecutive threads load consecutive elements of each slice
+      for (int e = tid; e < BM * BK; e += Threads)
+        As[e / BK][e % BK] = A[(row0 + e / BK) * wA + k0 + e % BK];
+      for (int e = tid; e < BK * BN; e += Threads)
+        Bs[e / BN][e % BN] = B[(k0 + e / BN) * wB + col0 + e % BN];
+      __syncthreads();
+
+      for (int k = 0; k < BK; k++) {
+        int a[TM], b[TN];
+        #pragma GCC unroll 16
+        for (int i = 0; i < TM; i++) a[i] = As[ty + i * ThreadsY][k];
+        #pragma GCC unroll 16
+        for (int j = 0; j < TN; j++) b[j] = Bs[k][tx + j * ThreadsX];
+        #pragma GCC unroll 16
+        for (int i = 0; i < TM; i++)
+          #pragma GCC unroll 16
+          for (int j = 0; j < TN; j++)
+            acc[i][j] = noclMulAdd(a[i], b[j], acc[i][j]);
+      }
+      __syncthreads();
+    }
+
+    // Write the results
+    // (Consecutive threads write consecutive columns)
+    #pragma GCC unroll 16
+    for (int i = 0; i < TM; i++)
+      #pragma GCC unroll 16
+      for (int j = 0; j < TN; j++)
+        C[(row0 + ty + i * ThreadsY) * wB + col0 + tx + j * ThreadsX] =
+          acc[i][j];
+  }
+};
+
+// Tile parameters: 64x64 tiles of C, slices of depth 16, and 4x4
+// outputs per thread, giving 256-thread blocks whose two slices
+// (8KB) fill their share of the banked SRAMs
+typedef TiledGEMM<64, 64, 16, 4, 4> GEMM;
+
+// Run kernel on square matrices and check result
+template <typename K> bool run(K* k, int size, int* matA, int* matB,
+                               int* matC) {
+  k->wA = size;
+  k->wB = size;
+  k->A = matA;
+  k->B = matB;
+  k->C = matC;
+
+  // Invoke kernel
+  noclFill(matC, size*size, 0);
+  noclRunKernelAndDumpStats(k);
+  puts("MACs: "); puthex(size * size * size); putchar('\n');
+
+  // Check result, a row at a time
+  // (Accessing B by row keeps the CPU's cache effective)
+  bool ok = true;
+  int row[size];
+  for (int i = 0; i < size; i++) {
+    for (int j = 0; j < size; j++) row[j] = 0;
+    for (int k = 0; k < size; k++) {
+      int a = matA[i*size+k];
+      for (int j = 0; j < size; j++) row[j] += a * matB[k*size+j];
+    }
+    for (int j = 0; j < size; j++) ok = ok && row[j] == matC[i*size+j];
+  }
+  return ok;
+}
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Matrix dimensions for benchmarking
+  // (Must be multiples of the tile sizes)
+  int minSize = isSim ? 64 : 256;
+  int maxSize = isSim ? 64 : 512;
+
+  bool ok = true;
+  for (int size = minSize; size <= maxSize; size *= 2) {
+    // Input and outputs
+    nocl_aligned int matA[size*size], matB[size*size], matC[size*size];
+
+    // Initialise matrices (in parallel, on the SIMT core)
+    randFill(matA, size*size, 1, 0xff);
+    randFill(matB, size*size, 2, 0xff);
+
+    puts("Size: "); puthex(size); putchar('\n');
+
+    // One output per thread
+    puts("Simple\n");
+    SimpleGEMM<SIMTLanes> simple;
+    simple.blockDim.x = SIMTLanes;
+    simple.blockDim.y = SIMTLanes;
+    simple.gridDim.x = size / SIMTLanes;
+    simple.gridDim.y = size / SIMTLanes;
+    ok = run(&simple, size, matA, matB, matC) && ok;
+
+    // Register tiled
+    puts("Register tiled\n");
+    GEMM tiled;
+    tiled.blockDim.x = GEMM::ThreadsX;
+    tiled.blockDim.y = GEMM::ThreadsY;
+    tiled.gridDim.x = size / GEMM::TileN;
+    tiled.gridDim.y = size / GEMM::TileM;
+    ok = run(&tiled, size, matA, matB, matC) && ok;
+  }
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
@@ -90,7 +90,7 @@ template <int BlockSize> struct MatMul : Kernel {
       // each thread computes one element
       // of the block sub-matrix
       for (int k = 0; k < BlockSize; ++k) {
-        Csub += As[ty][k] * Bs[k][tx];
+        Csub = noclMulAdd(As[ty][k], Bs[k][tx], Csub);
       }
 
       // Synchronize to make sure that the preceding
@@ -116,7 +116,7 @@ int main()
   int size = isSim ? 32 : 256;
 
   // Input and outputs
-  simt_aligned int matA[size*size], matB[size*size],
+  nocl_aligned int matA[size*size], matB[size*size],
                    matC[size*size], matCheck[size*size];
 
   // Initialise matrices
@@ -17,7 +17,7 @@ template <int BlockSize> struct MatVecMul : Kernel {
       // Compute partial dot products
       int sum = 0;
       for (int x = threadIdx.x; x < width; x += blockDim.x)
-        sum += row[x] * vecIn[x];
+        sum = noclMulAdd(row[x], vecIn[x], sum);
       partial[threadIdx.x] = sum;
       __syncthreads();
 
@@ -46,16 +46,11 @@ int main()
   int height = isSim ? 64 : 1024;
 
   // Input and outputs
-  simt_aligned int mat[height*width], vecIn[width], vecOut[height];
+  nocl_aligned int mat[height*width], vecIn[width], vecOut[height];
 
-  // Initialise inputs
-  uint32_t seed = 1;
-  for (int j = 0; j < width; j++)
-    vecIn[j] = rand15(&seed) & 0xff;
-  for (int i = 0; i < height; i++) {
-    for (int j = 0; j < width; j++)
-      mat[i*width+j] = rand15(&seed) & 0xff;
-  }
+  // Initialise inputs (in parallel, on the SIMT core)
+  randFill(vecIn, width, 1, 0xff);
+  randFill(mat, height * width, 2, 0xff);
 
   // Instantiate kernel
   MatVecMul<SIMTLanes> k;
@@ -64,6 +59,9 @@ int main()
   k.blockDim.x = SIMTLanes;
   k.gridDim.x = SIMTWarps;
 
+  // Input vector is reused by every row, so cache global loads
+  k.useL1Cache = true;
+
   // Assign parameters
   k.width = width;
   k.height = height;
@@ -0,0 +1,69 @@
+#include <NoCL.h>
+#include <Rand.h>
+
+// Number of buckets in hash table (deliberately not a power of two)
+#define NUM_BUCKETS 1021
+
+// Bucket index of key, using a multiplicative hash reduced modulo
+// the table size in each round (as in double hashing with probing)
+unsigned bucketOf(unsigned key, int rounds) {
+  unsigned h = key % NUM_BUCKETS;
+  for (int r = 0; r < rounds; r++)
+    h = (h * 2654435761u + key) % NUM_BUCKETS;
+  return h;
+}
+
+// Compute bucket index of every key.  Dominated by remainder
+// operations, which exercise the divider configuration of the SIMT
+// core (sequential per lane, full-throughput per lane, or shared).
+struct ModHash : Kernel {
+  int len, rounds;
+  unsigned *keys, *buckets;
+
+  void kernel() {
+    for (int i = threadIdx.x; i < len; i += blockDim.x)
+      buckets[i] = bucketOf(keys[i], rounds);
+  }
+};
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Vector size for benchmarking
+  int N = isSim ? 1024 : 102400;
+
+  // Input and output vectors
+  nocl_aligned unsigned keys[N], buckets[N];
+
+  // Initialise inputs (in parallel, on the SIMT core)
+  randFill(keys, N, 1);
+
+  // Instantiate kernel
+  ModHash k;
+
+  // Use single block of threads
+  k.blockDim.x = SIMTLanes * SIMTWarps;
+
+  // Assign parameters
+  k.len = N;
+  k.rounds = 4;
+  k.keys = keys;
+  k.buckets = buckets;
+
+  // Invoke kernel
+  noclRunKernelAndDumpStats(&k);
+
+  // Check result
+  bool ok = true;
+  for (int i = 0; i < N; i++)
+    ok = ok && buckets[i] == bucketOf(keys[i], k.rounds);
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include <NoCL.h>
+#include <Rand.h>
+
+// Hamming-distance search: for each binary vector in a database,
+// compute its distance from a query vector.  Each thread handles one
+// database vector, whose words are stored interleaved (word j of every
+// vector, then word j+1 of every vector, ...) so that accesses by a
+// warp are coalesced.  The inner loop is dominated by population
+// counts and index arithmetic.
+struct PopCount : Kernel {
+  int numVecs, numWords;
+  uint32_t *db, *query;
+  int *dist;
+
+  void kernel() {
+    for (int i = threadIdx.x; i < numVecs; i += blockDim.x) {
+      int d = 0;
+      for (int j = 0; j < numWords; j++)
+        d += noclPopCount(db[j * numVecs + i] ^ query[j]);
+      dist[i] = d;
+    }
+  }
+};
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Database size for benchmarking
+  int numVecs = isSim ? 256 : 4096;
+  int numWords = isSim ? 16 : 64;
+
+  // Database, query, and distances
+  nocl_aligned uint32_t db[numWords * numVecs];
+  nocl_aligned uint32_t query[numWords];
+  nocl_aligned int dist[numVecs];
+
+  // Initialise inputs (in parallel, on the SIMT core)
+  randFill(db, numWords * numVecs, 1);
+  randFill(query, numWords, 2);
+
+  // Instantiate kernel
+  PopCount k;
+
+  // Use single block of threads
+  k.blockDim.x = SIMTLanes * SIMTWarps;
+
+  // Assign parameters
+  k.numVecs = numVecs;
+  k.numWords = numWords;
+  k.db = db;
+  k.query = query;
+  k.dist = dist;
+
+  // Invoke kernel
+  noclRunKernelAndDumpStats(&k);
+
+  // Check result (counting bits one at a time)
+  bool ok = true;
+  for (int i = 0; i < numVecs; i++) {
+    int d = 0;
+    for (int j = 0; j < numWords; j++) {
+      uint32_t x = db[j * numVecs + i] ^ query[j];
+      for (int b = 0; b < 32; b++) d += (x >> b) & 1;
+    }
+    ok = ok && dist[i] == d;
+  }
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
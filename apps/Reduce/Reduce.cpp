@@ -1,6 +1,7 @@
 #include <NoCL.h>
+#include <Rand.h>
 
-// Kernel for vector summation
+// Kernel for vector summation, using a single block
 template <int BlockSize> struct Reduce : Kernel {
   int len;
   int *in, *sum;
@@ -36,7 +37,7 @@ int main()
   int N = isSim ? 3000 : 1000000;
 
   // Input and outputs
-  simt_aligned int in[N];
+  nocl_aligned int in[N];
   int sum;
 
   // Initialise inputs
@@ -58,11 +59,34 @@ int main()
   k.sum = &sum;
 
   // Invoke kernel
+  puts("Single block\n");
   noclRunKernelAndDumpStats(&k);
 
   // Check result
   bool ok = sum == acc;
 
+  // Multi-block reduction
+  puts("Multi-block\n");
+  unsigned cycles;
+  ok = ok && noclReduce<NoCLSum<int>>(in, N, &cycles) == acc;
+
+  // Achieved DRAM bandwidth, as a percentage of peak (one beat per
+  // cycle)
+  unsigned beats = (N * sizeof(int)) / DRAMBeatBytes;
+  puts("DRAMBandwidthPercent: "); puthex((beats * 100) / cycles);
+  putchar('\n');
+
+  // Other operators
+  randFill(in, N, 1);
+  int max = in[0];
+  unsigned min = in[0];
+  for (int i = 1; i < N; i++) {
+    if (in[i] > max) max = in[i];
+    if ((unsigned) in[i] < min) min = in[i];
+  }
+  ok = ok && noclReduce<NoCLMax<int>>(in, N) == max;
+  ok = ok && noclReduce<NoCLMin<unsigned>>((unsigned*) in, N) == min;
+
   // Display result
   puts("Self test: ");
   puts(ok ? "PASSED" : "FAILED");
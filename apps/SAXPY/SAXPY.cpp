@@ -0,0 +1,63 @@
+#include <NoCL.h>
+#include <Rand.h>
+
+// Single-precision a * x + y
+struct SAXPY : Kernel {
+  int len;
+  float a;
+  float *x, *y;
+
+  void kernel() {
+    for (int i = threadIdx.x; i < len; i += blockDim.x)
+      y[i] = noclFMA(a, x[i], y[i]);
+  }
+};
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Vector size for benchmarking
+  int N = isSim ? 3000 : 1000000;
+
+  // Input and output vectors
+  nocl_aligned float x[N], y[N], check[N];
+
+  // Initialise inputs (values in the range [-1, 1))
+  uint32_t seed = 1;
+  for (int i = 0; i < N; i++) {
+    x[i] = (float) ((int) rand15(&seed) - 16384) / 16384.0f;
+    y[i] = (float) ((int) rand15(&seed) - 16384) / 16384.0f;
+  }
+
+  // Instantiate kernel
+  SAXPY k;
+
+  // Use a single block of threads
+  k.blockDim.x = SIMTWarps * SIMTLanes;
+
+  // Assign parameters
+  k.len = N;
+  k.a = 2.5f;
+  k.x = x;
+  k.y = y;
+
+  // Expected result, computed before y is overwritten
+  // (Using the same noclFMA, so the result is bit-exact)
+  for (int i = 0; i < N; i++) check[i] = noclFMA(k.a, x[i], y[i]);
+
+  // Invoke kernel
+  noclRunKernelAndDumpStats(&k);
+
+  // Check result
+  bool ok = true;
+  for (int i = 0; i < N; i++) ok = ok && y[i] == check[i];
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+#include <NoCL.h>
+#include <Rand.h>
+
+// Single-precision matrix multiplication C = A * B, using square
+// tiles of A and B staged in shared local memory (as in MatMul)
+// (wA is A's width and wB is B's width)
+template <int BlockSize> struct SGEMM : Kernel {
+  float *A, *B, *C;
+  int wA, wB;
+
+  void kernel() {
+    // Tiles of A and B
+    auto As = shared.array<float, BlockSize, BlockSize>();
+    auto Bs = shared.array<float, BlockSize, BlockSize>();
+
+    // Block and thread indices
+    int bx = blockIdx.x, by = blockIdx.y;
+    int tx = threadIdx.x, ty = threadIdx.y;
+
+    // Range of tiles of A processed by the block, and step sizes
+    int aBegin = wA * BlockSize * by;
+    int aEnd = aBegin + wA - 1;
+    int aStep = BlockSize;
+    int bBegin = BlockSize * bx;
+    int bStep = BlockSize * wB;
+
+    // Element of the block's tile of C computed by the thread
+    float Csub = 0.0f;
+
+    for (int a = aBegin, b = bBegin; a <= aEnd; a += aStep, b += bStep) {
+      // Each thread loads one element of each tile
+      As[ty][tx] = A[a + wA * ty + tx];
+      Bs[ty][tx] = B[b + wB * ty + tx];
+      __syncthreads();
+
+      // Multiply the tiles together
+      for (int k = 0; k < BlockSize; ++k)
+        Csub = noclFMA(As[ty][k], Bs[k][tx], Csub);
+      __syncthreads();
+    }
+
+    // Write the result
+    int c = wB * BlockSize * by + BlockSize * bx;
+    C[c + wB * ty + tx] = Csub;
+  }
+};
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Matrix dimensions for benchmarking
+  // (Must be a multiple of SIMTLanes)
+  int size = isSim ? 32 : 256;
+
+  // Input and outputs
+  nocl_aligned float matA[size*size], matB[size*size], matC[size*size];
+
+  // Initialise matrices (values in the range [-1, 1))
+  uint32_t seed = 1;
+  for (int i = 0; i < size*size; i++) {
+    matA[i] = (float) ((int) (rand15(&seed) & 0xff) - 128) / 128.0f;
+    matB[i] = (float) ((int) (rand15(&seed) & 0xff) - 128) / 128.0f;
+  }
+
+  // Instantiate kernel
+  SGEMM<SIMTLanes> k;
+
+  // One block of threads per matrix tile
+  k.blockDim.x = SIMTLanes;
+  k.blockDim.y = SIMTLanes;
+  k.gridDim.x = size / SIMTLanes;
+  k.gridDim.y = size / SIMTLanes;
+
+  // Assign parameters
+  k.wA = size;
+  k.wB = size;
+  k.A = matA;
+  k.B = matB;
+  k.C = matC;
+
+  // Invoke kernel
+  noclRunKernelAndDumpStats(&k);
+
+  // Check result
+  // (The kernel accumulates in the same order using the same fused
+  // operation, so the result is bit-exact)
+  bool ok = true;
+  for (int i = 0; i < size; i++)
+    for (int j = 0; j < size; j++) {
+      float sum = 0.0f;
+      for (int k = 0; k < size; k++)
+        sum = noclFMA(matA[i*size+k], matB[k*size+j], sum);
+      ok = ok && sum == matC[i*size+j];
+    }
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
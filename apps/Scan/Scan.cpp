@@ -22,10 +22,12 @@ template <int BlockSize> struct Scan : Kernel {
       // Local scan
       for (int offset = 1; offset < blockDim.x; offset <<= 1) {
         swap(tempIn, tempOut);
-        if (t >= offset)
-          tempOut[t] = tempIn[t] + tempIn[t - offset];
-        else
-          tempOut[t] = tempIn[t];
+        // Branch-free version of:
+        //   tempOut[t] = tempIn[t] + (t >= offset ? tempIn[t - offset] : 0)
+        // (every thread loads a valid element; no divergence)
+        bool active = t >= offset;
+        int other = tempIn[noclSelect(active, t - offset, 0)];
+        tempOut[t] = tempIn[t] + noclSelect(active, other, 0);
         __syncthreads();
       }
 
@@ -46,10 +48,10 @@ int main()
   int N = isSim ? 4096 : 1024000;
 
   // Input and output vectors
-  simt_aligned int in[N], out[N];
+  nocl_aligned int in[N], out[N];
 
-  // Initialise inputs
-  for (int i = 0; i < N; i++) in[i] = i;
+  // Initialise inputs (on the SIMT core)
+  noclIota(in, N);
 
   // Instantiate kernel
   Scan<SIMTWarps * SIMTLanes> k;
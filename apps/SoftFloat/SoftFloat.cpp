@@ -0,0 +1,82 @@
+#include <NoCL.h>
+#include <Rand.h>
+#include <SoftFloat.h>
+
+// Evaluate a polynomial at each input (Horner's method), and output
+// the result in fixed point, with its sign in the LSB.  Instantiated
+// with native float (libgcc's soft-float routines, or Zfinx) and with
+// the branch-free SoftFloat, to compare divergence.
+template <typename T> struct Poly : Kernel {
+  int len;
+  int *in, *out;
+  T inScale, outScale;
+  T coeffs[5];
+
+  void kernel() {
+    for (int i = threadIdx.x; i < len; i += blockDim.x) {
+      T x = T(in[i]) * inScale;
+      T p = coeffs[4];
+      for (int j = 3; j >= 0; j--) p = p * x + coeffs[j];
+      out[i] = (int) (p * outScale) * 2 + (p < T(0.0f));
+    }
+  }
+};
+
+// Run kernel
+template <typename T> void run(int len, int* in, int* out) {
+  // Instantiate kernel
+  Poly<T> k;
+
+  // Use a single block of threads
+  k.blockDim.x = SIMTWarps * SIMTLanes;
+
+  // Assign parameters
+  k.len = len;
+  k.in = in;
+  k.out = out;
+  k.inScale = T(1.0f / 16384.0f);
+  k.outScale = T(1000.0f);
+  k.coeffs[0] = T(0.5f);
+  k.coeffs[1] = T(-1.25f);
+  k.coeffs[2] = T(0.75f);
+  k.coeffs[3] = T(2.0f);
+  k.coeffs[4] = T(-0.375f);
+
+  // Invoke kernel
+  noclRunKernelAndDumpStats(&k);
+}
+
+int main()
+{
+  // Are we in simulation?
+  bool isSim = getchar();
+
+  // Vector size for benchmarking
+  int N = isSim ? 3000 : 1000000;
+
+  // Inputs and outputs
+  nocl_aligned int in[N], out[N], check[N];
+
+  // Initialise inputs (the polynomial is evaluated in the range [-2, 2))
+  uint32_t seed = 1;
+  for (int i = 0; i < N; i++) in[i] = (int) (rand15(&seed) << 1) - 32768;
+
+  // Compare native and branch-free versions
+  puts("Native float\n");
+  run<float>(N, in, check);
+  puts("SoftFloat\n");
+  run<SoftFloat>(N, in, out);
+
+  // Check result
+  // (Values stay in the normal range, so flushing subnormals to zero
+  // makes no difference and the results are identical)
+  bool ok = true;
+  for (int i = 0; i < N; i++) ok = ok && out[i] == check[i];
+
+  // Display result
+  puts("Self test: ");
+  puts(ok ? "PASSED" : "FAILED");
+  putchar('\n');
+
+  return 0;
+}
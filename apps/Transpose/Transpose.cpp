@@ -6,7 +6,7 @@ template <int SquareSize> struct Transpose : Kernel {
   Array2D<int> in, out;
   
   void kernel() {
-    auto square = shared.array<int, SquareSize, SquareSize+1>();
+    auto square = shared.swizzledArray<int, SquareSize, SquareSize>();
     
     // Origin of square within matrix
     int originX = blockIdx.x * blockDim.x;
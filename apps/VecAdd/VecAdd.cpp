@@ -20,13 +20,11 @@ int main()
   int N = isSim ? 3000 : 1000000;
 
   // Input and output vectors
-  simt_aligned int a[N], b[N], result[N];
+  nocl_aligned int a[N], b[N], result[N];
 
-  // Initialise inputs
-  for (int i = 0; i < N; i++) {
-    a[i] = i;
-    b[i] = 2*i;
-  }
+  // Initialise inputs (on the SIMT core)
+  noclIota(a, N, 0, 1);
+  noclIota(b, N, 0, 2);
 
   // Instantiate kernel
   VecAdd k;
@@ -5,12 +5,12 @@
 int gcd(int x, int y) {
   noclPush();
     while (x != y) {
-      noclPush();
-        if (x > y)
-          x = x-y;
-        else
-          y = y-x;
-      noclPop();
+      // Branch-free version of: if (x > y) x = x-y; else y = y-x;
+      // (no divergence, and hence no push/pop, within the loop body)
+      bool gt = x > y;
+      int diff = noclSelect(gt, x-y, y-x);
+      x = noclSelect(gt, diff, x);
+      y = noclSelect(gt, y, diff);
     }
   noclPop();
   return x;
@@ -36,7 +36,7 @@ int main()
   int N = isSim ? 100 : 100000;
 
   // Input and output vectors
-  simt_aligned int a[N], b[N], result[N];
+  nocl_aligned int a[N], b[N], result[N];
 
   // Initialise inputs
   uint32_t seed = 100;
@@ -24,6 +24,12 @@ NOTE("Maximum number of inflight requests supported by DRAM wrapper")
 NOTE("SIMT configuration")
 NOTE("==================")
 
+NOTE("Number of SIMT cores (each with its own banked SRAMs)")
+NOTE("Stack space grows with the number of cores, so SIMTLogBytesPerStack")
+NOTE("may need reducing when adding cores")
+#define SIMTCores 1
+#define SIMTLogCores 0
+
 NOTE("Number of lanes per SIMT core")
 #define SIMTLanes 32
 #define SIMTLogLanes 5
@@ -44,6 +50,9 @@ NOTE("Stack size (in bytes) for each SIMT thread")
 NOTE("Size of each SRAM bank (in words)")
 #define SIMTLogWordsPerSRAMBank 9
 
+NOTE("XOR bank index with row index on SRAM accesses (avoids conflicts)?")
+#define SIMTSwizzleSRAMBanks 0
+
 NOTE("Enable SIMT stat counters")
 #define SIMTEnableStatCounters 1
 
@@ -56,6 +65,34 @@ NOTE("Use full-throughput divider (rather than sequential divider)")
 NOTE("Latency of full-throughput divider")
 #define SIMTFullDividerLatency 12
 
+NOTE("Number of full-throughput dividers shared by the lanes of a SIMT")
+NOTE("core (must divide SIMTLanes), or 0 for a divider per lane")
+NOTE("(If non-zero, SIMTUseFullDivider is ignored)")
+#define SIMTSharedDividers 0
+
+NOTE("Enable integer multiply-accumulate custom instruction")
+NOTE("(Needs pebbles support for the MAC mnemonic and a third operand)")
+#define SIMTEnableMAC 0
+
+NOTE("Enable packed 4x8-bit and 2x16-bit SIMD custom instructions")
+NOTE("(Needs pebbles support for the packed mnemonics and a third operand)")
+#define SIMTEnablePackedSIMD 0
+
+NOTE("Promote byte/halfword loads to word loads to aid coalescing?")
+#define SIMTCoalesceSubWordLoads 1
+
+NOTE("Include L1 data cache for SIMT DRAM loads? (Enabled per kernel)")
+#define SIMTEnableL1Cache 0
+
+NOTE("Size of SIMT L1 data cache (in DRAM beats)")
+#define SIMTL1CacheLogBeats 9
+
+NOTE("Merge consecutive DRAM loads from coalescing unit into bursts?")
+#define SIMTEnableBurstMerging 1
+
+NOTE("Max cycles to wait for a mergeable DRAM load before issuing burst")
+#define SIMTBurstMergeWindow 2
+
 NOTE("CPU configuration")
 NOTE("=================")
 
@@ -68,6 +105,13 @@ NOTE("Number of cache lines (line size == DRAM beat size)")
 NOTE("Use register forwarding for increased IPC but possibly lower Fmax?")
 #define CPUEnableRegForwarding 0
 
+NOTE("DMA engine")
+NOTE("==========")
+
+NOTE("Include DMA engine for bulk DRAM copies and fills? (Programmed by")
+NOTE("CPU via SoC control registers)")
+#define EnableDMA 1
+
 NOTE("Tagged memory")
 NOTE("=============")
 
@@ -95,6 +139,25 @@ NOTE("=============")
 NOTE("Is CHERI enabled? (If so, see UseClang and EnableTaggedMem settings)")
 #define EnableCHERI 0
 
+NOTE("ISA extensions")
+NOTE("==============")
+
+NOTE("Support bit-manipulation extensions Zba and Zbb? (Applies to both")
+NOTE("CPU and SIMT cores, since they run code from the same binary)")
+NOTE("(Needs pebbles support for the Zba/Zbb mnemonics)")
+#define EnableZb 0
+
+NOTE("Support integer conditional operations extension Zicond? (Applies")
+NOTE("to both CPU and SIMT cores)")
+NOTE("(Needs pebbles support for the Zicond mnemonics)")
+#define EnableZicond 0
+
+NOTE("Support single-precision floating point in integer registers")
+NOTE("(Zfinx)? Subnormals are flushed to zero and there is no fcsr")
+NOTE("(Applies to both CPU and SIMT cores)")
+NOTE("(Needs pebbles support for the Zfinx mnemonics and a third operand)")
+#define EnableZfinx 0
+
 NOTE("Compiler")
 NOTE("========")
 
@@ -0,0 +1,116 @@
+// Host-side access to the SoC control registers, stats and DMA engine
+// (Kept separate from NoCL.h so that start-up code can use the DMA
+// engine without pulling in the rest of the library)
+
+#ifndef _DMA_H_
+#define _DMA_H_
+
+#include <Config.h>
+#include <SoCCtrl.h>
+#include <SoCStats.h>
+#include <Pebbles/Common.h>
+#include <Pebbles/Instrs/CacheMgmt.h>
+#include <Pebbles/CSRs/SIMTHost.h>
+
+#if EnableCHERI
+#include <cheriintrin.h>
+#endif
+
+// SoC control and stats
+// =====================
+
+// Write a SoC-level control register
+INLINE void noclSetSoCCtrl(unsigned reg, unsigned val) {
+  while (!pebblesSIMTCanPut()) {}
+  pebblesSIMTWriteInstr(SOC_CTRL_BASE + 4 * reg, val);
+}
+
+// Read a stat counter from the SIMT core (or the SoC stats unit)
+INLINE unsigned noclGetStat(unsigned statId) {
+  while (!pebblesSIMTCanPut()) {}
+  pebblesSIMTAskStats(statId);
+  while (!pebblesSIMTCanGet()) {}
+  return pebblesSIMTGet();
+}
+
+// DMA engine
+// ==========
+
+// Bulk DRAM copies and fills performed by the DMA engine, without
+// involving the SIMT core.  The engine works on whole DRAM beats: all
+// addresses, lengths and strides must be multiples of DRAMBeatBytes.
+// Starting an operation writes back and invalidates the CPU's cache,
+// and the CPU must not access the affected memory until the operation
+// completes.
+
+#if EnableDMA
+
+// Byte address of pointer, as seen by the DMA engine
+INLINE uint32_t noclDMAAddr(const void* p) {
+  #if EnableCHERI
+    return cheri_address_get(p);
+  #else
+    return (uint32_t) p;
+  #endif
+}
+
+// Is DMA engine busy?
+INLINE bool noclDMABusy() { return noclGetStat(STAT_SOC_DMA_BUSY) != 0; }
+
+// Wait for DMA operation to complete
+INLINE void noclDMAWait() { while (noclDMABusy()) {} }
+
+// Start DMA operation on a 2D region (without waiting for completion):
+// rows of rowBytes bytes, with the given distances between starts of
+// consecutive rows
+INLINE void noclDMAStart(unsigned op,
+                         void* dst, unsigned dstStride,
+                         const void* src, unsigned srcStride,
+                         unsigned rowBytes, unsigned rows,
+                         uint32_t fill = 0) {
+  noclDMAWait();
+  pebblesCacheFlushFull();
+  noclSetSoCCtrl(SOC_CTRL_DMA_SRC, noclDMAAddr(src));
+  noclSetSoCCtrl(SOC_CTRL_DMA_DST, noclDMAAddr(dst));
+  noclSetSoCCtrl(SOC_CTRL_DMA_ROW_BYTES, rowBytes);
+  noclSetSoCCtrl(SOC_CTRL_DMA_ROWS, rows);
+  noclSetSoCCtrl(SOC_CTRL_DMA_SRC_STRIDE, srcStride);
+  noclSetSoCCtrl(SOC_CTRL_DMA_DST_STRIDE, dstStride);
+  noclSetSoCCtrl(SOC_CTRL_DMA_FILL, fill);
+  noclSetSoCCtrl(SOC_CTRL_DMA_START, op);
+}
+
+// Copy bytes from src to dst (regions must not overlap)
+INLINE void noclDMACopy(void* dst, const void* src, unsigned bytes) {
+  noclDMAStart(DMA_OP_COPY, dst, 0, src, 0, bytes, 1);
+  noclDMAWait();
+}
+
+// Copy 2D region: rows of rowBytes bytes, with the given strides
+INLINE void noclDMACopy2D(void* dst, unsigned dstStride,
+                          const void* src, unsigned srcStride,
+                          unsigned rowBytes, unsigned rows) {
+  noclDMAStart(DMA_OP_COPY, dst, dstStride, src, srcStride,
+               rowBytes, rows);
+  noclDMAWait();
+}
+
+// Set every word of region to given value
+INLINE void noclDMAFill(void* dst, unsigned bytes, uint32_t word) {
+  noclDMAStart(DMA_OP_FILL, dst, 0, dst, 0, bytes, 1, word);
+  noclDMAWait();
+}
+
+// Given a region of memory, find the offset of the first beat boundary
+// within it (or its size, if there is none) and the number of whole
+// beats' worth of bytes that follow
+INLINE void noclDMASplit(const void* p, unsigned bytes,
+                         unsigned* offset, unsigned* beatBytes) {
+  unsigned head = -noclDMAAddr(p) & (DRAMBeatBytes - 1);
+  *offset = head < bytes ? head : bytes;
+  *beatBytes = (bytes - *offset) & ~(DRAMBeatBytes - 1);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,196 @@
+// Fixed-point maths for integer-only kernels
+//
+// Values are Q16.16 (fix16_t: 16 integer bits, 16 fractional bits) or
+// Q1.31 (q31_t: a fraction in [-1, 1)).  Every function runs a fixed
+// sequence of instructions: ranges are reduced with count-leading-zeros
+// and shifts, functions are approximated by polynomials (Horner's
+// method in Q2.30), and special cases are handled with branch-free
+// selects.  So threads of a warp never diverge, and the cost of each
+// call is independent of its input.  Results that do not fit saturate.
+
+#ifndef _FIXEDPOINT_H_
+#define _FIXEDPOINT_H_
+
+#include <NoCL.h>
+
+typedef int32_t fix16_t;
+typedef int32_t q31_t;
+
+// Constants
+#define FIX16_ONE 0x00010000
+#define FIX16_MAX 0x7fffffff
+#define FIX16_MIN ((fix16_t) 0x80000000)
+#define FIX16_PI  205887
+#define Q31_MAX   0x7fffffff
+
+// Conversions
+// ===========
+
+INLINE fix16_t fixFromInt(int x) { return x << 16; }
+
+// Round to nearest integer
+INLINE int fixToInt(fix16_t x) { return (x + 0x8000) >> 16; }
+
+// Helpers
+// =======
+
+// Count leading zeros (32 if input is zero), without branching
+INLINE uint32_t fixClz(uint32_t x) { return noclClz(x); }
+
+// Multiply Q2.30 value by unsigned Q0.32 fraction, giving Q2.30
+// (A single mulhsu)
+INLINE int32_t fixMulFrac(int32_t a, uint32_t f) {
+  return (int32_t) (((int64_t) a * (int64_t) (uint64_t) f) >> 32);
+}
+
+// Multiply Q2.30 values
+INLINE int32_t fixMulQ30(int32_t a, int32_t b) {
+  return (int32_t) (((int64_t) a * b + (1 << 29)) >> 30);
+}
+
+// Arithmetic
+// ==========
+
+// Multiply Q16.16 values (rounding to nearest)
+INLINE fix16_t fixMul(fix16_t a, fix16_t b) {
+  return (fix16_t) (((int64_t) a * b + 0x8000) >> 16);
+}
+
+// Multiply Q1.31 values (rounding to nearest)
+INLINE q31_t q31Mul(q31_t a, q31_t b) {
+  return (q31_t) (((int64_t) a * b + (1 << 30)) >> 31);
+}
+
+// Reciprocal: normalise to [0.5, 1), then three Newton-Raphson steps
+// from a linear estimate.  Accurate to within one LSB; the reciprocal
+// of zero (or of values too small) saturates.
+INLINE fix16_t fixRecip(fix16_t x) {
+  uint32_t neg = (uint32_t) x >> 31;
+  uint32_t mag = ((uint32_t) x ^ -neg) + neg;
+  uint32_t lz = fixClz(mag);
+  uint32_t d = mag << (lz & 31);
+
+  // Estimate 48/17 - 32/17 d, in Q2.30
+  uint32_t r = 3031741621u - (uint32_t) (((uint64_t) d * 2021161081u) >> 32);
+  for (int i = 0; i < 3; i++) {
+    uint32_t e = ((uint64_t) d * r) >> 32;
+    r = ((uint64_t) r * (0x80000000u - e)) >> 30;
+  }
+
+  // 1/x = r * 2^(lz-30) in Q16.16, rounded
+  uint32_t s = (30 - lz) & 31;
+  uint32_t q = (r + ((1u << s) >> 1)) >> s;
+  uint32_t sat = (lz > 30) | (q > FIX16_MAX);
+  q = noclSelect(sat != 0, (uint32_t) FIX16_MAX, q);
+  return (fix16_t) ((q ^ -neg) + neg);
+}
+
+// Square root (rounded down), computed digit by digit: 24 iterations
+// of a shift and a compare-and-subtract.  Negative inputs give zero.
+INLINE fix16_t fixSqrt(fix16_t x) {
+  uint32_t n = noclSelect(x < 0, 0u, (uint32_t) x);
+  uint32_t rem = 0, root = 0;
+  for (int i = 0; i < 24; i++) {
+    rem = (rem << 2) | (n >> 30);
+    n <<= 2;
+    uint32_t trial = (root << 2) | 1;
+    uint32_t ge = rem >= trial;
+    rem -= trial & -ge;
+    root = (root << 1) | ge;
+  }
+  return root;
+}
+
+// Exponential: e^x = 2^(x log2(e)), split into integer and fractional
+// parts; 2^f uses a degree-5 polynomial.  The result is rounded to
+// nearest, so e^0 is exactly one.  Error is within one LSB (relative to
+// the result, for results above one); results over FIX16_MAX saturate.
+INLINE fix16_t fixExp(fix16_t x) {
+  // y = x * log2(e), with 46 fractional bits
+  int64_t y = (int64_t) x * 1549082005;
+  int32_t n = (int32_t) (y >> 46);
+  uint32_t f = (uint32_t) (y >> 14);
+
+  // 2^f in Q2.30, for f in [0, 1)
+  int32_t p = 2033403;
+  p = fixMulFrac(p, f) + 9609550;
+  p = fixMulFrac(p, f) + 59979580;
+  p = fixMulFrac(p, f) + 257850314;
+  p = fixMulFrac(p, f) + 744268966;
+  p = fixMulFrac(p, f) + 1073741715;
+
+  // Scale by 2^n: result is p * 2^(n-14), rounded to nearest (p is
+  // below 2^31, so keeping one extra bit for the rounding cannot overflow)
+  int32_t s = 14 - n;
+  uint32_t t = ((uint32_t) p << 1) >> (s & 31);
+  uint32_t r = noclSelect(s > 31, 0u, (t + 1) >> 1);
+  return noclSelect(s < 0, (uint32_t) FIX16_MAX, r);
+}
+
+// Natural logarithm: normalise x to 2^e (1 + t) with t in [0, 1), then
+// ln(x) = e ln(2) + ln(1 + t), using a degree-7 polynomial for the
+// latter.  Error is within one LSB.  Non-positive inputs give
+// FIX16_MIN.
+INLINE fix16_t fixLog(fix16_t x) {
+  uint32_t lz = fixClz(x);
+  uint32_t t = ((uint32_t) x << (lz & 31)) << 1;
+  int32_t e = 15 - (int32_t) lz;
+
+  // ln(1 + t) in Q2.30
+  int32_t p = 10747393;
+  p = fixMulFrac(p, t) - 56304377;
+  p = fixMulFrac(p, t) + 140481324;
+  p = fixMulFrac(p, t) - 239622522;
+  p = fixMulFrac(p, t) + 351355936;
+  p = fixMulFrac(p, t) - 536103239;
+  p = fixMulFrac(p, t) + 1073706477;
+  p = fixMulFrac(p, t) + 274;
+
+  // Add e ln(2), using ln(2) with 32 fractional bits
+  int64_t r = (int64_t) e * 2977044472u + ((int64_t) p << 2);
+  r = (r + 0x8000) >> 16;
+  return noclSelect(x <= 0, FIX16_MIN, (fix16_t) r);
+}
+
+// Sine of an angle given in turns (Q0.32, so the range reduction is
+// free), in Q1.31.  The angle is folded into [-1/4, 1/4] turn and an
+// odd polynomial of degree 11 is used.  Error is within 6 LSBs.
+INLINE q31_t q31SinTurns(uint32_t turns) {
+  // Reflect angles in the second and third quadrants
+  uint32_t fold = (turns + 0x40000000u) > 0x80000000u;
+  int32_t v = (int32_t) noclSelect(fold != 0, 0x80000000u - turns, turns);
+
+  // sin(pi/2 w) for w = 4v in [-1, 1], in Q2.30 (v is already w in Q2.30)
+  int32_t w2 = fixMulQ30(v, v);
+  int32_t p = -3685;
+  p = fixMulQ30(p, w2) + 172072;
+  p = fixMulQ30(p, w2) - 5026892;
+  p = fixMulQ30(p, w2) + 85569282;
+  p = fixMulQ30(p, w2) - 693598666;
+  p = fixMulQ30(p, w2) + 1686629713;
+  int64_t r = ((int64_t) p * v + (1 << 28)) >> 29;
+  q31_t q = noclSelect(r > Q31_MAX, Q31_MAX, (q31_t) r);
+  return noclSelect(r < -(int64_t) Q31_MAX - 1, (q31_t) 0x80000000, q);
+}
+
+INLINE q31_t q31CosTurns(uint32_t turns) {
+  return q31SinTurns(turns + 0x40000000u);
+}
+
+// Convert angle in radians to turns (modulo one turn)
+INLINE uint32_t fixToTurns(fix16_t x) {
+  return (uint32_t) (((int64_t) x * 683565276) >> 16);
+}
+
+// Sine and cosine of an angle in radians.  Error is within one LSB
+// for angles below 1024 radians; beyond that, the error in the
+// conversion to turns grows with the angle.
+INLINE fix16_t fixSin(fix16_t x) {
+  return ((q31SinTurns(fixToTurns(x)) >> 14) + 1) >> 1;
+}
+
+INLINE fix16_t fixCos(fix16_t x) {
+  return ((q31CosTurns(fixToTurns(x)) >> 14) + 1) >> 1;
+}
+
+#endif
@@ -11,7 +11,9 @@
 
 // Sum of stack sizes for all SIMT threads
 #define SIMT_STACKS_SIZE \
-  (1 << (SIMTLogLanes + SIMTLogWarps + SIMTLogBytesPerStack))
+  (1ull << (SIMTLogCores + SIMTLogLanes + SIMTLogWarps + SIMTLogBytesPerStack))
+#define SIMT_STACKS_SIZE_LINK \
+  (1 << (SIMTLogCores + SIMTLogLanes + SIMTLogWarps + SIMTLogBytesPerStack))
 
 // Sum of sizes of banked SRAMs
 #define BANKED_SRAMS_SIZE \
@@ -23,7 +25,12 @@
 // SIMT local memory is toward the end of DRAM, before SIMT thread stacks
 #define LOCAL_MEM_BASE (DRAM_SIZE - SIMT_STACKS_SIZE - BANKED_SRAMS_SIZE)
 #define LOCAL_MEM_BASE_LINK \
-  (DRAM_SIZE_LINK - SIMT_STACKS_SIZE - BANKED_SRAMS_SIZE)
+  (DRAM_SIZE_LINK - SIMT_STACKS_SIZE_LINK - BANKED_SRAMS_SIZE)
+
+// SIMT stacks and banked SRAMs must leave room for data memory
+#if SIMT_STACKS_SIZE + BANKED_SRAMS_SIZE >= DRAM_SIZE - DMEM_BASE
+#error "SIMT stacks do not fit in DRAM: reduce SIMTLogBytesPerStack"
+#endif
 
 // Base of CPU stack (growing down) is before SIMT local memory
 #define STACK_BASE (LOCAL_MEM_BASE_LINK - 8)
@@ -4,6 +4,8 @@
 #define _NOCL_H_
 
 #include <Config.h>
+#include <SoCCtrl.h>
+#include <SoCStats.h>
 #include <MemoryMap.h>
 #include <Pebbles/Common.h>
 #include <Pebbles/UART/IO.h>
@@ -16,6 +18,7 @@
 #include <Pebbles/CSRs/SIMTHost.h>
 #include <Pebbles/CSRs/SIMTDevice.h>
 #include <Pebbles/CSRs/CycleCount.h>
+#include <DMA.h>
 
 #if EnableCHERI
 #include <cheriintrin.h>
@@ -27,21 +30,81 @@
 // Utility functions
 // =================
 
+// Count leading zeros (32 if input is zero)
+// (Single instruction with Zbb; the compiler needs no zero check)
+INLINE unsigned noclClz(unsigned x) {
+  #if EnableZb
+    return x == 0 ? 32 : __builtin_clz(x);
+  #else
+    // Binary search by mask-and-shift, without branches
+    unsigned n = 0, s;
+    s = ((x >> 16) == 0) << 4; n += s; x <<= s;
+    s = ((x >> 24) == 0) << 3; n += s; x <<= s;
+    s = ((x >> 28) == 0) << 2; n += s; x <<= s;
+    s = ((x >> 30) == 0) << 1; n += s; x <<= s;
+    s = ((x >> 31) == 0); n += s; x <<= s;
+    return n + (x == 0);
+  #endif
+}
+
+// Count number of set bits
+INLINE unsigned noclPopCount(unsigned x) {
+  #if EnableZb
+    return __builtin_popcount(x);
+  #else
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0f0f0f0f;
+    return (x * 0x01010101) >> 24;
+  #endif
+}
+
+// Count trailing zeros (32 if input is zero)
+INLINE unsigned noclCtz(unsigned x) {
+  #if EnableZb
+    return x == 0 ? 32 : __builtin_ctz(x);
+  #else
+    // Count the ones below the lowest set bit (all 32 if x is zero)
+    return noclPopCount((x & (~x + 1)) - 1);
+  #endif
+}
+
 // Return input where only first non-zero bit is set, starting from LSB
+// (Written as x & ~(x-1) so that Zbb's andn can be used)
 inline unsigned firstHot(unsigned x) {
-  return x & (~x + 1);
+  return x & ~(x - 1);
 }
 
 // Is the given value a power of two?
+// (Uses cpop with Zbb; the software popcount would be slower)
 inline bool isOneHot(unsigned x) {
-  return x > 0 && (x & ~firstHot(x)) == 0;
+  #if EnableZb
+    return noclPopCount(x) == 1;
+  #else
+    return x > 0 && (x & ~firstHot(x)) == 0;
+  #endif
 }
 
 // Compute logarithm (base 2) 
 inline unsigned log2floor(unsigned x) {
-  unsigned count = 0;
-  while (x > 1) { x >>= 1; count++; }
-  return count;
+  return x == 0 ? 0 : 31 - noclClz(x);
+}
+
+// Branch-free select: returns (cond ? a : b) for 32-bit integer types
+// without a branch, so threads of a warp never diverge on the choice
+// (Zicond's czero.eqz/czero.nez plus an or; masking otherwise)
+template <typename T> INLINE T noclSelect(bool cond, T a, T b) {
+  static_assert(sizeof(T) == 4, "noclSelect: 32-bit types only");
+  unsigned c = cond;
+  unsigned x = (unsigned) a, y = (unsigned) b;
+  #if EnableZicond
+    asm("czero.eqz %0, %0, %1" : "+r"(x) : "r"(c));
+    asm("czero.nez %0, %0, %1" : "+r"(y) : "r"(c));
+    return (T) (x | y);
+  #else
+    unsigned mask = -c;
+    return (T) ((x & mask) | (y & ~mask));
+  #endif
 }
 
 // Swap the values of two variables
@@ -96,6 +159,84 @@ template <typename T> struct Array3D {
   }
 };
 
+// Unsigned division by a loop-invariant divisor, using a multiply-high
+// (mulhu) and shifts instead of the divider (Granlund & Montgomery's
+// round-up method, valid for all 32-bit numerators and divisors > 0).
+// The magic numbers are computed on the CPU when the divisor is
+// assigned to a kernel parameter, so kernels just use / and %.
+struct FastDivisor {
+  unsigned divisor, magic;
+  unsigned char shift1, shift2;
+
+  FastDivisor() {}
+  FastDivisor(unsigned d) : divisor(d) {
+    // l = ceil(log2(d))
+    unsigned l = d == 1 ? 0 : 32 - noclClz(d - 1);
+    // magic = floor(2^32 * (2^l - d) / d) + 1, by long division
+    // (2^l - d < d, so the quotient fits in 32 bits; this avoids
+    // 64-bit division, for which there is no runtime library)
+    unsigned r = (l == 32 ? 0 : (1u << l)) - d;
+    unsigned q = 0;
+    for (int i = 0; i < 32; i++) {
+      unsigned carry = r >> 31;
+      r <<= 1; q <<= 1;
+      if (carry || r >= d) { r -= d; q |= 1; }
+    }
+    magic = q + 1;
+    shift1 = l < 1 ? l : 1;
+    shift2 = l < 1 ? 0 : l - 1;
+  }
+
+  INLINE unsigned div(unsigned n) const {
+    unsigned t = (unsigned) (((uint64_t) magic * n) >> 32);
+    return (t + ((n - t) >> shift1)) >> shift2;
+  }
+
+  INLINE unsigned mod(unsigned n) const { return n - div(n) * divisor; }
+};
+
+INLINE unsigned operator/(unsigned n, const FastDivisor& d)
+  { return d.div(n); }
+INLINE unsigned operator%(unsigned n, const FastDivisor& d)
+  { return d.mod(n); }
+
+// 2D arrays in shared local memory with a swizzled layout: element
+// (i, j) is stored in column j XOR (i mod SIMTLanes).  Accessing a
+// row or a column of the array is then free of bank conflicts,
+// without any padding.  When the hardware applies the swizzle itself
+// (SIMTSwizzleSRAMBanks), it XORs the bank index with the index of the
+// SIMTLanes-word row of banks being accessed.  That matches the array
+// row only when dim2 is SIMTLanes, in which case indexing is plain;
+// for wider arrays, the software XOR cancels the hardware's and
+// substitutes the array row, segment by segment.
+template <typename T, int dim2> struct SwizzledArray2D {
+  static_assert(sizeof(T) == 4,
+    "NoCL: SwizzledArray2D requires word-sized elements");
+  static_assert((dim2 % SIMTLanes) == 0,
+    "NoCL: SwizzledArray2D width must be a multiple of SIMTLanes");
+
+  // Single row of a swizzled array
+  struct Row {
+    T* base;
+    int row;
+    INLINE T& operator[](int col) const {
+      #if SIMTSwizzleSRAMBanks
+        if (dim2 == SIMTLanes) return base[col];
+        unsigned bankRow =
+          (unsigned) (uintptr_t) &base[col] >> (SIMTLogLanes + 2);
+        return base[col ^ ((row ^ bankRow) & (SIMTLanes-1))];
+      #else
+        return base[col ^ (row & (SIMTLanes-1))];
+      #endif
+    }
+  };
+
+  T* base;
+  INLINE Row operator[](int row) const {
+    Row r; r.base = &base[row * dim2]; r.row = row; return r;
+  }
+};
+
 // For shared local memory allocation
 // Memory is allocated/released using a stack
 // TODO: constraint bounds when CHERI enabled
@@ -140,6 +281,18 @@ struct SharedLocalMem {
     return (T (*)[dim2][dim3]) alloc<dim1 * dim2 * dim3 * sizeof(T)>();
   }
 
+  // Allocate 2D array with static size and swizzled layout
+  // (Aligned to a row of banks so that swizzling is effective)
+  template <typename T, int dim1, int dim2>
+    SwizzledArray2D<T, dim2> swizzledArray() {
+      constexpr int rowBytes = SIMTLanes * 4;
+      unsigned offset = (unsigned) (uintptr_t) top & (rowBytes - 1);
+      if (offset != 0) top += rowBytes - offset;
+      SwizzledArray2D<T, dim2> a;
+      a.base = (T*) alloc<dim1 * dim2 * sizeof(T)>();
+      return a;
+    }
+
   // Allocate 1D array with dynamic size
   template <typename T> Array<T> array(int n) {
     Array<T> a; a.base = (T*) alloc(n * sizeof(T));
@@ -173,6 +326,10 @@ struct Kernel {
 
   // Shared local memory
   SharedLocalMem shared;
+
+  // Cache global loads in SIMT L1 data cache? (Chosen per launch)
+  // Benefits kernels that reuse global data but not shared memory
+  bool useL1Cache = false;
 };
 
 // Kernel invocation
@@ -206,8 +363,13 @@ template <typename K> __attribute__ ((noinline)) void _noclSIMTMain_() {
   k.threadIdx.z = 0;
 
   // Set initial block index
-  unsigned blockIdxWithinSM = pebblesHartId() >> (blockXShift + blockYShift);
-  k.blockIdx.x = blockIdxWithinSM;
+  // (Blocks are distributed round-robin over SIMT cores)
+  unsigned smId = pebblesHartId() >> (SIMTLogWarps + SIMTLogLanes);
+  unsigned blockIdxWithinSM =
+    (pebblesHartId() >> (blockXShift + blockYShift)) & (k.blocksPerSM - 1);
+  unsigned firstBlockIdx = smId * k.blocksPerSM + blockIdxWithinSM;
+  unsigned blockIdxStride = k.blocksPerSM * SIMTCores;
+  k.blockIdx.x = firstBlockIdx;
   k.blockIdx.y = 0;
 
   // Set base of shared local memory (per block)
@@ -229,10 +391,10 @@ template <typename K> __attribute__ ((noinline)) void _noclSIMTMain_() {
       k.kernel();
       pebblesSIMTConverge();
       pebblesSIMTLocalBarrier();
-      k.blockIdx.x += k.blocksPerSM;
+      k.blockIdx.x += blockIdxStride;
     }
     pebblesSIMTConverge();
-    k.blockIdx.x = blockIdxWithinSM;
+    k.blockIdx.x = firstBlockIdx;
     k.blockIdx.y++;
   }
 
@@ -248,7 +410,7 @@ template <typename K> __attribute__ ((noinline))
   void _noclSIMTEntry_() {
     // Determine stack pointer based on SIMT thread id
     uint32_t top = 0;
-    top -= (SIMTLanes * SIMTWarps - 1 - pebblesHartId()) <<
+    top -= (SIMTCores * SIMTLanes * SIMTWarps - 1 - pebblesHartId()) <<
              SIMTLogBytesPerStack;
     top -= 8;
     // Set stack pointer
@@ -301,6 +463,11 @@ template <typename K> __attribute__ ((noinline))
     while (!pebblesSIMTCanPut()) {}
     pebblesSIMTSetKernel(kernelAddr);
 
+    // Enable L1 data cache, if requested
+    #if SIMTEnableL1Cache
+      noclSetSoCCtrl(SOC_CTRL_L1_ENABLE, k->useL1Cache);
+    #endif
+
     // Flush cache
     pebblesCacheFlushFull();
 
@@ -329,22 +496,169 @@ template <typename K> __attribute__ ((noinline))
     if (ret == 2) puts("Kernel failed due to exception\n");
 
     // Get number of cycles taken
-    while (!pebblesSIMTCanPut()) {}
-    pebblesSIMTAskStats(STAT_SIMT_CYCLES);
-    while (!pebblesSIMTCanGet()) {}
-    unsigned numCycles = pebblesSIMTGet();
+    unsigned numCycles = noclGetStat(STAT_SIMT_CYCLES);
     puts("Cycles: "); puthex(numCycles); putchar('\n');
 
     // Get number of instructions executed
-    while (!pebblesSIMTCanPut()) {}
-    pebblesSIMTAskStats(STAT_SIMT_INSTRS);
-    while (!pebblesSIMTCanGet()) {}
-    unsigned numInstrs = pebblesSIMTGet();
+    unsigned numInstrs = noclGetStat(STAT_SIMT_INSTRS);
     puts("Instrs: "); puthex(numInstrs); putchar('\n');
 
+    // Get number of DRAM load bursts and beats
+    // (Average burst length is DRAMLoadBeats / DRAMLoadBursts)
+    unsigned loadBursts = noclGetStat(STAT_SOC_DRAM_LOAD_BURSTS);
+    unsigned loadBeats = noclGetStat(STAT_SOC_DRAM_LOAD_BEATS);
+    puts("DRAMLoadBursts: "); puthex(loadBursts); putchar('\n');
+    puts("DRAMLoadBeats: "); puthex(loadBeats); putchar('\n');
+
+    // Get shared local memory (banked SRAM) stats
+    unsigned sramReqs = noclGetStat(STAT_SOC_SRAM_LANE_REQS);
+    unsigned sramStalls = noclGetStat(STAT_SOC_SRAM_STALL_CYCLES);
+    unsigned sramMcasts = noclGetStat(STAT_SOC_SRAM_MCAST_HITS);
+    puts("SRAMReqs: "); puthex(sramReqs); putchar('\n');
+    puts("SRAMStallCycles: "); puthex(sramStalls); putchar('\n');
+    puts("SRAMMcastHits: "); puthex(sramMcasts); putchar('\n');
+
+    // Get L1 data cache stats
+    if (SIMTEnableL1Cache && k->useL1Cache) {
+      unsigned l1Hits = noclGetStat(STAT_SOC_L1_HITS);
+      unsigned l1Misses = noclGetStat(STAT_SOC_L1_MISSES);
+      puts("L1Hits: "); puthex(l1Hits); putchar('\n');
+      puts("L1Misses: "); puthex(l1Misses); putchar('\n');
+    }
+
     return ret;
   }
 
+// Array utilities
+// ===============
+
+// Kernels to initialise and copy arrays on the SIMT core, callable from
+// the CPU in one line.  Consecutive threads access consecutive words,
+// so accesses are coalesced.  Elements must be 32 bits (or a multiple,
+// for copying).  When the DMA engine is enabled, fills and copies use
+// it instead for the beat-aligned part of the array, and the CPU
+// handles any ends.
+
+template <typename T> struct NoCLFill : Kernel {
+  int len;
+  T val;
+  T* out;
+
+  void kernel() {
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < len;
+             i += gridDim.x * blockDim.x)
+      out[i] = val;
+  }
+};
+
+template <typename T> struct NoCLIota : Kernel {
+  int len;
+  T start, step;
+  T* out;
+
+  void kernel() {
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < len;
+             i += gridDim.x * blockDim.x)
+      out[i] = start + (T) i * step;
+  }
+};
+
+struct NoCLCopy : Kernel {
+  int len;
+  const uint32_t* src;
+  uint32_t* dst;
+
+  void kernel() {
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < len;
+             i += gridDim.x * blockDim.x)
+      dst[i] = src[i];
+  }
+};
+
+// Run utility kernel using all SIMT threads: one full-size block per
+// SIMT core, with the kernel taking a grid-stride share of the array
+template <typename K> INLINE void noclRunUtility(K* k) {
+  k->blockDim.x = SIMTWarps * SIMTLanes;
+  k->gridDim.x = SIMTCores;
+  noclRunKernel(k);
+}
+
+// Set every element of array to val
+template <typename T> INLINE void noclFill(T* out, int len, T val) {
+  static_assert(sizeof(T) == 4, "noclFill: 32-bit types only");
+  #if EnableDMA
+    unsigned offset, beatBytes;
+    noclDMASplit(out, len * 4, &offset, &beatBytes);
+    int mid = offset / 4, end = mid + beatBytes / 4;
+    if (beatBytes > 0) {
+      uint32_t word;
+      __builtin_memcpy(&word, &val, 4);
+      noclDMAFill(out + mid, beatBytes, word);
+    }
+    for (int i = 0; i < mid; i++) out[i] = val;
+    for (int i = end; i < len; i++) out[i] = val;
+  #else
+    NoCLFill<T> k;
+    k.len = len;
+    k.val = val;
+    k.out = out;
+    noclRunUtility(&k);
+  #endif
+}
+
+// Set element i of array to start + i * step
+template <typename T>
+  INLINE void noclIota(T* out, int len, T start = 0, T step = 1) {
+    static_assert(sizeof(T) == 4, "noclIota: 32-bit types only");
+    NoCLIota<T> k;
+    k.len = len;
+    k.start = start;
+    k.step = step;
+    k.out = out;
+    noclRunUtility(&k);
+  }
+
+// Copy len elements from src to dst (arrays must not overlap)
+template <typename T> INLINE void noclCopy(T* dst, const T* src, int len) {
+  static_assert(sizeof(T) % 4 == 0, "noclCopy: 32-bit multiples only");
+  int words = len * (sizeof(T) / 4);
+  uint32_t* d = (uint32_t*) dst;
+  const uint32_t* s = (const uint32_t*) src;
+  #if EnableDMA
+    // The DMA engine can be used when both arrays have the same
+    // alignment relative to a beat
+    unsigned offset, beatBytes;
+    noclDMASplit(dst, words * 4, &offset, &beatBytes);
+    if (beatBytes > 0 &&
+          ((noclDMAAddr(dst) ^ noclDMAAddr(src)) & (DRAMBeatBytes-1)) == 0) {
+      int mid = offset / 4, end = mid + beatBytes / 4;
+      noclDMACopy(d + mid, s + mid, beatBytes);
+      for (int i = 0; i < mid; i++) d[i] = s[i];
+      for (int i = end; i < words; i++) d[i] = s[i];
+      return;
+    }
+  #endif
+  NoCLCopy k;
+  k.len = words;
+  k.src = s;
+  k.dst = d;
+  noclRunUtility(&k);
+}
+
+// Set bytes of memory to c, like memset().  The word-aligned middle
+// is filled using noclFill(), and any unaligned ends by the CPU.
+INLINE void noclMemset(void* dst, int c, unsigned bytes) {
+  uint8_t* p = (uint8_t*) dst;
+  uint8_t* end = p + bytes;
+  while (p != end && ((uintptr_t) p & 3)) *p++ = c;
+  unsigned words = (end - p) >> 2;
+  if (words > 0) {
+    noclFill((uint32_t*) p, words, (uint32_t) (uint8_t) c * 0x01010101);
+    p += words << 2;
+  }
+  while (p != end) *p++ = c;
+}
+
 // Explicit convergence
 INLINE void noclPush() { pebblesSIMTPush(); }
 INLINE void noclPop() { pebblesSIMTPop(); }
@@ -356,4 +670,350 @@ INLINE void __syncthreads() {
   pebblesSIMTLocalBarrier();
 }
 
+// Parallel primitives
+// ===================
+
+// Histogram of values (each less than NumBins), with a private copy of
+// the bins in shared local memory per warp, so that the atomic updates
+// of different warps do not contend.  As many copies as fit in the
+// block's share of shared memory are used (rounded down to a power of
+// two), and warps share copies beyond that.  Blocks take a grid-stride
+// share of the input, and each writes its merged copies to its own
+// row of the partial histograms.
+template <typename T, int NumBins> struct NoCLHistogram : Kernel {
+  int len;
+  const T* in;
+  int* partial;
+
+  void kernel() {
+    // Private copies of the bins
+    // (The banked SRAMs are divided equally between resident blocks)
+    int warps = blockDim.x >> SIMTLogLanes;
+    int fit = (BANKED_SRAMS_SIZE / blocksPerSM) / (NumBins * 4);
+    int copies = 1 << log2floor(fit < warps ? fit : warps);
+    int* histo = shared.alloc<int>(copies * NumBins);
+    int* mine = &histo[((threadIdx.x >> SIMTLogLanes) & (copies-1)) *
+                         NumBins];
+
+    // Initialise bins
+    for (int i = threadIdx.x; i < copies * NumBins; i += blockDim.x)
+      histo[i] = 0;
+
+    __syncthreads();
+
+    // Update bins
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < len;
+             i += gridDim.x * blockDim.x)
+      atomicAdd(&mine[in[i]], 1);
+
+    __syncthreads();
+
+    // Merge copies and write partial histogram to global memory
+    for (int b = threadIdx.x; b < NumBins; b += blockDim.x) {
+      int sum = 0;
+      for (int c = 0; c < copies; c++) sum += histo[c * NumBins + b];
+      partial[blockIdx.x * NumBins + b] = sum;
+    }
+  }
+};
+
+// Sum partial histograms
+template <int NumBins> struct NoCLHistogramMerge : Kernel {
+  int numPartials;
+  const int* partial;
+  int* bins;
+
+  void kernel() {
+    for (int b = threadIdx.x; b < NumBins; b += blockDim.x) {
+      int sum = 0;
+      for (int p = 0; p < numPartials; p++) sum += partial[p * NumBins + b];
+      bins[b] = sum;
+    }
+  }
+};
+
+// Compute histogram of len values into NumBins bins, using one block
+// of 256 threads per 256 SIMT threads and a second kernel to sum the
+// blocks' partial histograms (held on the CPU stack).  Stats can be
+// dumped for the first kernel, which does almost all the work.
+template <int NumBins, typename T>
+  INLINE void noclHistogram(const T* in, int len, int* bins,
+                            bool dumpStats = false) {
+    constexpr int blockSize = 256;
+    constexpr int blocksPerSM = (SIMTWarps * SIMTLanes) / blockSize;
+    static_assert(NumBins * 4 <= BANKED_SRAMS_SIZE / blocksPerSM,
+      "noclHistogram: too many bins for shared local memory");
+    constexpr int numBlocks = blocksPerSM * SIMTCores;
+    nocl_aligned int partial[numBlocks * NumBins];
+
+    NoCLHistogram<T, NumBins> k;
+    k.blockDim.x = blockSize;
+    k.gridDim.x = numBlocks;
+    k.len = len;
+    k.in = in;
+    k.partial = partial;
+    if (dumpStats) noclRunKernelAndDumpStats(&k); else noclRunKernel(&k);
+
+    NoCLHistogramMerge<NumBins> m;
+    m.blockDim.x = blockSize;
+    m.numPartials = numBlocks;
+    m.partial = partial;
+    m.bins = bins;
+    noclRunKernel(&m);
+  }
+
+// Smallest and largest values of arithmetic types
+template <typename T> struct NoCLLimits {
+  static constexpr bool isSigned = (T) -1 < 0;
+  static constexpr T lowest =
+    isSigned ? (T) (1ull << (8 * sizeof(T) - 1)) : (T) 0;
+  static constexpr T highest = (T) ~lowest;
+};
+
+template <> struct NoCLLimits<float> {
+  static constexpr float lowest = -__builtin_inff();
+  static constexpr float highest = __builtin_inff();
+};
+
+// Reduction operators, each with an identity element
+template <typename T> struct NoCLSum {
+  static constexpr T identity = 0;
+  INLINE static T apply(T a, T b) { return a + b; }
+};
+
+template <typename T> struct NoCLMin {
+  static constexpr T identity = NoCLLimits<T>::highest;
+  INLINE static T apply(T a, T b) { return b < a ? b : a; }
+};
+
+template <typename T> struct NoCLMax {
+  static constexpr T identity = NoCLLimits<T>::lowest;
+  INLINE static T apply(T a, T b) { return b > a ? b : a; }
+};
+
+// Reduce len values to one using an associative operator.  Blocks take
+// a grid-stride share of the input; each thread combines four elements
+// per iteration (independent loads, a grid stride apart, so every load
+// of a warp stays coalesced), then the block combines its threads'
+// values in a shared-memory tree and writes the result to out[blockIdx.x].
+template <typename T, typename Op> struct NoCLReduce : Kernel {
+  int len;
+  const T* in;
+  T* out;
+
+  void kernel() {
+    T* vals = shared.alloc<T>(blockDim.x);
+
+    // Combine elements of global memory
+    int stride = gridDim.x * blockDim.x;
+    int i = blockIdx.x * blockDim.x + threadIdx.x;
+    T acc = Op::identity;
+    for (; i + 3 * stride < len; i += 4 * stride) {
+      T x0 = in[i], x1 = in[i + stride];
+      T x2 = in[i + 2 * stride], x3 = in[i + 3 * stride];
+      acc = Op::apply(acc, Op::apply(Op::apply(x0, x1), Op::apply(x2, x3)));
+    }
+    for (; i < len; i += stride) acc = Op::apply(acc, in[i]);
+    vals[threadIdx.x] = acc;
+
+    __syncthreads();
+
+    // Combine values in shared local memory
+    for (int n = blockDim.x >> 1; n > 0; n >>= 1) {
+      if (threadIdx.x < n)
+        vals[threadIdx.x] = Op::apply(vals[threadIdx.x],
+                                      vals[threadIdx.x + n]);
+      __syncthreads();
+    }
+
+    // Write block's result to global memory
+    if (threadIdx.x == 0) out[blockIdx.x] = vals[0];
+  }
+};
+
+// Reduce len values to one: a first kernel reduces the input to one
+// value per block (using blocks of 256 threads over all SIMT threads),
+// and a second, single-block kernel reduces those.  If cycles is
+// non-null, stats are dumped for the first kernel, which does almost
+// all the work, and its cycle count is returned through it.
+template <typename Op, typename T>
+  INLINE T noclReduce(const T* in, int len, unsigned* cycles = 0) {
+    constexpr int blockSize = 256;
+    constexpr int numBlocks =
+      (SIMTWarps * SIMTLanes) / blockSize * SIMTCores;
+    nocl_aligned T partial[numBlocks];
+    nocl_aligned T result[1];
+
+    NoCLReduce<T, Op> k;
+    k.blockDim.x = blockSize;
+    k.gridDim.x = numBlocks;
+    k.len = len;
+    k.in = in;
+    k.out = partial;
+    if (cycles) {
+      noclRunKernelAndDumpStats(&k);
+      *cycles = noclGetStat(STAT_SIMT_CYCLES);
+    }
+    else noclRunKernel(&k);
+
+    NoCLReduce<T, Op> r;
+    r.blockDim.x = blockSize;
+    r.len = numBlocks;
+    r.in = partial;
+    r.out = result;
+    noclRunKernel(&r);
+    return result[0];
+  }
+
+// Custom instructions
+// ===================
+
+// Integer multiply-accumulate: returns a * b + c
+// (A single instruction on SIMT lanes, when enabled)
+INLINE int noclMulAdd(int a, int b, int c) {
+  #if SIMTEnableMAC
+    int d;
+    asm (".insn r4 0x0b, 0, 0, %0, %1, %2, %3"
+          : "=r"(d) : "r"(a), "r"(b), "r"(c));
+    return d;
+  #else
+    return a * b + c;
+  #endif
+}
+
+// Packed SIMD: each 32-bit word holds 4x8-bit or 2x16-bit elements
+// (Single instructions on SIMT lanes, when enabled)
+
+// Saturate integer to range of element type T
+template <typename T> INLINE T noclSat(int x) {
+  const bool isSigned = (T) -1 < 0;
+  const int bits = 8 * sizeof(T);
+  const int lo = isSigned ? -(1 << (bits-1)) : 0;
+  const int hi = isSigned ? (1 << (bits-1)) - 1 : (1 << bits) - 1;
+  return (T) (x < lo ? lo : x > hi ? hi : x);
+}
+
+// Apply binary operator to each pair of elements in packed words
+template <typename T, typename F>
+  INLINE unsigned noclPackedMap(unsigned a, unsigned b, F f) {
+    const int bits = 8 * sizeof(T);
+    const unsigned mask = (1 << bits) - 1;
+    unsigned result = 0;
+    for (int i = 0; i < 32; i += bits)
+      result |= ((unsigned) f((T) (a >> i), (T) (b >> i)) & mask) << i;
+    return result;
+  }
+
+// Sum of products of pairs of elements in packed words, plus c
+template <typename T>
+  INLINE int noclPackedDot(unsigned a, unsigned b, int c) {
+    const int bits = 8 * sizeof(T);
+    for (int i = 0; i < 32; i += bits)
+      c += (int) (T) (a >> i) * (int) (T) (b >> i);
+    return c;
+  }
+
+// Define packed element-wise operation
+// (funct7 selects operation, funct3 selects element size)
+#if SIMTEnablePackedSIMD
+  #define NOCL_PACKED_OP(name, funct7, funct3, T, expr) \
+    INLINE unsigned name(unsigned a, unsigned b) { \
+      unsigned d; \
+      asm (".insn r 0x2b, " #funct3 ", " #funct7 ", %0, %1, %2" \
+            : "=r"(d) : "r"(a), "r"(b)); \
+      return d; \
+    }
+  #define NOCL_PACKED_DOT(name, funct3, T) \
+    INLINE int name(unsigned a, unsigned b, int c) { \
+      int d; \
+      asm (".insn r4 0x2b, " #funct3 ", 0, %0, %1, %2, %3" \
+            : "=r"(d) : "r"(a), "r"(b), "r"(c)); \
+      return d; \
+    }
+#else
+  #define NOCL_PACKED_OP(name, funct7, funct3, T, expr) \
+    INLINE unsigned name(unsigned a, unsigned b) { \
+      return noclPackedMap<T>(a, b, [](T x, T y) -> T { return expr; }); \
+    }
+  #define NOCL_PACKED_DOT(name, funct3, T) \
+    INLINE int name(unsigned a, unsigned b, int c) { \
+      return noclPackedDot<T>(a, b, c); \
+    }
+#endif
+
+// Wrapping add and subtract
+NOCL_PACKED_OP(noclAdd8, 0, 0, uint8_t, x + y)
+NOCL_PACKED_OP(noclAdd16, 0, 1, uint16_t, x + y)
+NOCL_PACKED_OP(noclSub8, 1, 0, uint8_t, x - y)
+NOCL_PACKED_OP(noclSub16, 1, 1, uint16_t, x - y)
+
+// Signed and unsigned min/max
+NOCL_PACKED_OP(noclMin8, 2, 0, int8_t, x < y ? x : y)
+NOCL_PACKED_OP(noclMin16, 2, 1, int16_t, x < y ? x : y)
+NOCL_PACKED_OP(noclMax8, 3, 0, int8_t, x < y ? y : x)
+NOCL_PACKED_OP(noclMax16, 3, 1, int16_t, x < y ? y : x)
+NOCL_PACKED_OP(noclMinU8, 4, 0, uint8_t, x < y ? x : y)
+NOCL_PACKED_OP(noclMinU16, 4, 1, uint16_t, x < y ? x : y)
+NOCL_PACKED_OP(noclMaxU8, 5, 0, uint8_t, x < y ? y : x)
+NOCL_PACKED_OP(noclMaxU16, 5, 1, uint16_t, x < y ? y : x)
+
+// Signed and unsigned saturating add and subtract
+NOCL_PACKED_OP(noclAddSat8, 6, 0, int8_t, noclSat<int8_t>(x + y))
+NOCL_PACKED_OP(noclAddSat16, 6, 1, int16_t, noclSat<int16_t>(x + y))
+NOCL_PACKED_OP(noclSubSat8, 7, 0, int8_t, noclSat<int8_t>(x - y))
+NOCL_PACKED_OP(noclSubSat16, 7, 1, int16_t, noclSat<int16_t>(x - y))
+NOCL_PACKED_OP(noclAddSatU8, 8, 0, uint8_t, noclSat<uint8_t>(x + y))
+NOCL_PACKED_OP(noclAddSatU16, 8, 1, uint16_t, noclSat<uint16_t>(x + y))
+NOCL_PACKED_OP(noclSubSatU8, 9, 0, uint8_t, noclSat<uint8_t>(x - y))
+NOCL_PACKED_OP(noclSubSatU16, 9, 1, uint16_t, noclSat<uint16_t>(x - y))
+
+// Signed and unsigned dot-product-accumulate
+NOCL_PACKED_DOT(noclDot8, 2, int8_t)
+NOCL_PACKED_DOT(noclDotU8, 3, uint8_t)
+NOCL_PACKED_DOT(noclDot16, 4, int16_t)
+NOCL_PACKED_DOT(noclDotU16, 5, uint16_t)
+
+#undef NOCL_PACKED_OP
+#undef NOCL_PACKED_DOT
+
+// Floating point
+// ==============
+
+// With Zfinx, the compiler emits single-precision instructions for
+// float arithmetic directly (operating on integer registers).  The
+// hardware flushes subnormals to zero, returns the canonical NaN, and
+// rounds to nearest-even unless an instruction encodes another mode.
+// Without Zfinx, float arithmetic is compiled to calls to libgcc's
+// soft-float routines, so apps using it must link with libgcc
+// (APP_LIBS = -lgcc), and only noclFMA is provided below.
+#if EnableZfinx
+
+// Fused multiply-add: returns a * b + c with a single rounding
+INLINE float noclFMA(float a, float b, float c) {
+  float d;
+  asm ("fmadd.s %0, %1, %2, %3" : "=r"(d) : "r"(a), "r"(b), "r"(c));
+  return d;
+}
+
+// Square root
+INLINE float noclSqrt(float x) {
+  float y;
+  asm ("fsqrt.s %0, %1" : "=r"(y) : "r"(x));
+  return y;
+}
+
+// Minimum and maximum (if one operand is NaN, the other is returned)
+INLINE float noclMinF(float a, float b) { return __builtin_fminf(a, b); }
+INLINE float noclMaxF(float a, float b) { return __builtin_fmaxf(a, b); }
+
+// Absolute value (a sign injection)
+INLINE float noclAbsF(float x) { return __builtin_fabsf(x); }
+
+#else
+
+// Multiply-add in software (rounded twice, unlike the Zfinx version)
+INLINE float noclFMA(float a, float b, float c) { return a * b + c; }
+
+#endif
+
 #endif
@@ -1,11 +1,63 @@
 #ifndef _RAND_H_
 #define _RAND_H_
 
-#include <Pebbles/Common.h>
+#include <NoCL.h>
 
+// Sequential generator (linear congruential), 15 bits per call
 INLINE uint32_t rand15(uint32_t* seed) {
   *seed = (*seed * 1664525 + 1013904223) & 0x7fffffff;
   return *seed >> 16;
 }
 
+// Counter-based generator: Philox-2x32-10 (Salmon et al., "Parallel
+// Random Numbers: As Easy as 1, 2, 3").  Each output is a pure
+// function of a counter and a key, so any thread can compute any
+// element of a random stream directly, with no state to carry.  Each
+// round is one 32x32 multiply (mul and mulhu).
+INLINE uint64_t philox2x32(uint32_t ctr0, uint32_t ctr1, uint32_t key) {
+  for (int i = 0; i < 10; i++) {
+    uint64_t prod = (uint64_t) 0xd256d193 * ctr0;
+    ctr0 = (uint32_t) (prod >> 32) ^ key ^ ctr1;
+    ctr1 = (uint32_t) prod;
+    key += 0x9e3779b9;
+  }
+  return ((uint64_t) ctr1 << 32) | ctr0;
+}
+
+// Element i of the random stream with the given seed
+INLINE uint32_t randAt(uint32_t seed, uint32_t i) {
+  return (uint32_t) philox2x32(i, 0, seed);
+}
+
+// Scale random word to the range [0, n) (a single mulhu)
+INLINE uint32_t randBelow(uint32_t r, uint32_t n) {
+  return (uint32_t) (((uint64_t) r * n) >> 32);
+}
+
+// Kernel to fill an array with elements of a random stream (ANDed
+// with a mask), so that large inputs are generated in parallel
+struct RandFill : Kernel {
+  int len;
+  uint32_t seed, mask;
+  uint32_t* out;
+
+  void kernel() {
+    for (int i = threadIdx.x; i < len; i += blockDim.x)
+      out[i] = randAt(seed, i) & mask;
+  }
+};
+
+// Fill array with random words, using the SIMT core
+template <typename T>
+  INLINE void randFill(T* out, int len, uint32_t seed,
+                       uint32_t mask = 0xffffffff) {
+    static_assert(sizeof(T) == 4, "randFill: 32-bit types only");
+    RandFill k;
+    k.len = len;
+    k.seed = seed;
+    k.mask = mask;
+    k.out = (uint32_t*) out;
+    noclRunUtility(&k);
+  }
+
 #endif
@@ -0,0 +1,49 @@
+#ifndef _SOC_CTRL_H_
+#define _SOC_CTRL_H_
+
+#ifndef NOTE
+#define NOTE(string)
+#endif
+
+NOTE("SoC-level control registers")
+NOTE("===========================")
+
+NOTE("These registers live outside the SIMT pipeline.  They are written")
+NOTE("using SIMT management instruction-write requests to addresses in")
+NOTE("the control window, which lies outside instruction memory.")
+
+NOTE("Base address of control window (register N at base + 4*N)")
+#define SOC_CTRL_BASE 0xffff0000
+
+NOTE("Enable SIMT L1 data cache for next kernel?")
+#define SOC_CTRL_L1_ENABLE 0
+
+NOTE("DMA engine: source and destination byte addresses")
+NOTE("(All DMA addresses, lengths and strides are multiples of")
+NOTE("DRAMBeatBytes)")
+#define SOC_CTRL_DMA_SRC 1
+#define SOC_CTRL_DMA_DST 2
+
+NOTE("DMA engine: bytes per row, and number of rows")
+#define SOC_CTRL_DMA_ROW_BYTES 3
+#define SOC_CTRL_DMA_ROWS 4
+
+NOTE("DMA engine: byte distance between starts of consecutive rows")
+#define SOC_CTRL_DMA_SRC_STRIDE 5
+#define SOC_CTRL_DMA_DST_STRIDE 6
+
+NOTE("DMA engine: word written by fill operations")
+#define SOC_CTRL_DMA_FILL 7
+
+NOTE("DMA engine: writing an operation here starts it")
+NOTE("(Completion is observed by polling stat STAT_SOC_DMA_BUSY)")
+#define SOC_CTRL_DMA_START 8
+
+NOTE("DMA operations")
+#define DMA_OP_COPY 1
+#define DMA_OP_FILL 2
+
+NOTE("Number of control registers")
+#define SOC_CTRL_NUM_REGS 9
+
+#endif
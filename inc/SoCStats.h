@@ -0,0 +1,50 @@
+#ifndef _SOC_STATS_H_
+#define _SOC_STATS_H_
+
+#ifndef NOTE
+#define NOTE(string)
+#endif
+
+NOTE("SoC-level stat counters")
+NOTE("=======================")
+
+NOTE("These counters live outside the SIMT pipeline and are served by")
+NOTE("the SoC stats unit in response to SIMT management stat requests.")
+NOTE("Ids start above those used by the SIMT pipeline's own counters.")
+NOTE("Like the pipeline's counters, they are cleared on kernel start.")
+
+NOTE("Smallest SoC-level stat id")
+#define STAT_SOC_BASE 16
+
+NOTE("DRAM load requests issued by SIMT coalescing unit")
+#define STAT_SOC_DRAM_LOAD_REQS 16
+
+NOTE("DRAM load bursts issued after burst merging")
+#define STAT_SOC_DRAM_LOAD_BURSTS 17
+
+NOTE("DRAM load beats requested")
+#define STAT_SOC_DRAM_LOAD_BEATS 18
+
+NOTE("Lane accesses to banked SRAMs (before coalescing)")
+#define STAT_SOC_SRAM_LANE_REQS 19
+
+NOTE("Requests reaching banked SRAMs")
+#define STAT_SOC_SRAM_REQS 20
+
+NOTE("Cycles in which a banked SRAM request is not accepted")
+NOTE("(due to bank conflicts or to response backpressure)")
+#define STAT_SOC_SRAM_STALL_CYCLES 21
+
+NOTE("Lane accesses to banked SRAMs served by multicast")
+#define STAT_SOC_SRAM_MCAST_HITS 22
+
+NOTE("DRAM beats loaded from SIMT L1 cache")
+#define STAT_SOC_L1_HITS 23
+
+NOTE("DRAM beats missing in SIMT L1 cache")
+#define STAT_SOC_L1_MISSES 24
+
+NOTE("Is DMA engine busy? (A status flag, not a counter: never cleared)")
+#define STAT_SOC_DMA_BUSY 25
+
+#endif
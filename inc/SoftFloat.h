@@ -0,0 +1,332 @@
+// Branch-free single-precision floating point in software
+//
+// The usual soft-float routines branch on special cases and loop to
+// normalise, so threads of a warp diverge whenever their operands
+// differ in kind or magnitude.  The routines here compute every case
+// unconditionally and pick the result with masks (or Zicond), so a
+// warp stays converged throughout.  Semantics match the Zfinx
+// hardware: round-to-nearest-even, subnormals flushed to zero, and a
+// canonical NaN.  Conversion to int truncates and saturates, like
+// fcvt.w.s with the rtz rounding mode.
+
+#ifndef _SOFTFLOAT_H_
+#define _SOFTFLOAT_H_
+
+#include <NoCL.h>
+
+// Helpers
+// =======
+
+// Branch-free select on a condition that is 0 or 1
+INLINE uint32_t sfSel(uint32_t cond, uint32_t a, uint32_t b) {
+  return noclSelect(cond != 0, a, b);
+}
+
+INLINE uint64_t sfSel64(uint32_t cond, uint64_t a, uint64_t b) {
+  uint64_t mask = -(uint64_t) cond;
+  return (a & mask) | (b & ~mask);
+}
+
+// Count leading zeros (32 if input is zero), without branching
+INLINE uint32_t sfClz(uint32_t x) { return noclClz(x); }
+
+// Minimum of two unsigned values
+INLINE uint32_t sfMin(uint32_t a, uint32_t b) {
+  return sfSel(a < b, a, b);
+}
+
+// Shift right, ORing the bits shifted out into the LSB.  Shifting by
+// 31 already leaves just (x != 0), so larger amounts are clamped.
+INLINE uint32_t sfShiftRightSticky(uint32_t x, uint32_t n) {
+  uint32_t s = sfMin(n, 31);
+  uint32_t r = x >> s;
+  return r | ((r << s) != x);
+}
+
+// 64-bit shifts by variable amounts, written on 32-bit halves: the
+// compiler's own sequences for these branch on the shift amount
+INLINE uint64_t sfShiftRightSticky64(uint64_t x, uint32_t n) {
+  uint32_t hi = x >> 32, lo = x;
+  uint32_t s = sfMin(n, 63);
+  uint32_t big = s >> 5;
+  uint32_t sticky = lo & -big;
+  lo = sfSel(big, hi, lo);
+  hi = hi & (big - 1);
+  s &= 31;
+  sticky |= (lo << 1) << (31 - s);
+  lo = (lo >> s) | ((hi << 1) << (31 - s));
+  hi = hi >> s;
+  return ((uint64_t) hi << 32) | lo | (sticky != 0);
+}
+
+INLINE uint64_t sfShiftLeft64(uint64_t x, uint32_t n) {
+  uint32_t hi = x >> 32, lo = x;
+  uint32_t big = (n >> 5) & 1;
+  hi = sfSel(big, lo, hi);
+  lo = lo & (big - 1);
+  uint32_t s = n & 31;
+  hi = (hi << s) | ((lo >> 1) >> (31 - s));
+  lo = lo << s;
+  return ((uint64_t) hi << 32) | lo;
+}
+
+INLINE uint32_t sfClz64(uint64_t x) {
+  uint32_t hi = x >> 32, lo = x;
+  uint32_t hiZero = hi == 0;
+  return sfClz(sfSel(hiZero, lo, hi)) + (hiZero << 5);
+}
+
+// Classification of an operand (subnormals count as zero)
+struct SoftFloatParts {
+  uint32_t sign, exp, man;
+  uint32_t isZero, isInf, isNaN;
+};
+
+INLINE SoftFloatParts sfUnpack(uint32_t x) {
+  SoftFloatParts p;
+  uint32_t frac = x & 0x7fffff;
+  p.sign = x >> 31;
+  p.exp = (x >> 23) & 0xff;
+  p.isZero = p.exp == 0;
+  p.isInf = (p.exp == 0xff) & (frac == 0);
+  p.isNaN = (p.exp == 0xff) & (frac != 0);
+  p.man = sfSel(p.isZero, 0, frac | 0x800000);
+  return p;
+}
+
+// Round a significand with its leading one in bit 31 to 24 bits (to
+// nearest, ties to even) and pack it with the given biased exponent,
+// saturating to infinity and flushing tiny results to zero
+INLINE uint32_t sfRoundPack(uint32_t sign, int32_t exp, uint32_t sig) {
+  uint32_t man = sig >> 8;
+  uint32_t rem = sig & 0xff;
+  uint32_t inc = (rem > 0x80) | ((rem == 0x80) & man);
+  man += inc;
+  exp += man >> 24;
+  uint32_t r = ((uint32_t) exp << 23) | (man & 0x7fffff);
+  r = sfSel(exp >= 0xff, 0x7f800000, r);
+  r = sfSel(exp <= 0, 0, r);
+  return r | (sign << 31);
+}
+
+// Canonical NaN
+static const uint32_t sfNaN = 0x7fc00000;
+
+// Arithmetic on raw bits
+// ======================
+
+// Addition
+INLINE uint32_t sfAdd(uint32_t a, uint32_t b) {
+  SoftFloatParts pa = sfUnpack(a), pb = sfUnpack(b);
+
+  // Order operands by magnitude, so that x is the larger
+  uint32_t magA = sfSel(pa.isZero, 0, a & 0x7fffffff);
+  uint32_t magB = sfSel(pb.isZero, 0, b & 0x7fffffff);
+  uint32_t swap = magA < magB;
+  uint32_t sx = sfSel(swap, pb.sign, pa.sign);
+  uint32_t sy = sfSel(swap, pa.sign, pb.sign);
+  uint32_t ex = sfSel(swap, pb.exp, pa.exp);
+  uint32_t ey = sfSel(swap, pa.exp, pb.exp);
+  uint32_t mx = sfSel(swap, pb.man, pa.man) << 7;
+  uint32_t my = sfSel(swap, pa.man, pb.man) << 7;
+
+  // Align and add (or subtract) significands
+  my = sfShiftRightSticky(my, ex - ey);
+  uint32_t sub = sx ^ sy;
+  uint32_t sum = mx + ((my ^ -sub) + sub);
+
+  // Normalise and round
+  uint32_t lz = sfClz(sum);
+  uint32_t r = sfRoundPack(sx, (int32_t) ex + 1 - (int32_t) lz,
+                             sum << (lz & 31));
+
+  // Exact zero is negative only when both operands are
+  r = sfSel(sum == 0, (sx & sy) << 31, r);
+
+  // Special cases
+  uint32_t anyInf = pa.isInf | pb.isInf;
+  r = sfSel(anyInf, (sx << 31) | 0x7f800000, r);
+  uint32_t nan = pa.isNaN | pb.isNaN | (pa.isInf & pb.isInf & sub);
+  return sfSel(nan, sfNaN, r);
+}
+
+// Subtraction
+INLINE uint32_t sfSub(uint32_t a, uint32_t b) {
+  return sfAdd(a, b ^ 0x80000000);
+}
+
+// Multiplication
+INLINE uint32_t sfMul(uint32_t a, uint32_t b) {
+  SoftFloatParts pa = sfUnpack(a), pb = sfUnpack(b);
+  uint32_t sign = pa.sign ^ pb.sign;
+
+  // 48-bit product, with leading one in bit 47 or 46
+  uint64_t prod = (uint64_t) pa.man * pb.man;
+  uint32_t hi = prod >> 16;
+  uint32_t sticky = (prod & 0xffff) != 0;
+  uint32_t top = hi >> 31;
+  uint32_t r = sfRoundPack(sign,
+                 (int32_t) pa.exp + (int32_t) pb.exp - 127 + (int32_t) top,
+                 (hi << (top ^ 1)) | sticky);
+
+  // Special cases
+  uint32_t anyZero = pa.isZero | pb.isZero;
+  uint32_t anyInf = pa.isInf | pb.isInf;
+  r = sfSel(anyZero, sign << 31, r);
+  r = sfSel(anyInf, (sign << 31) | 0x7f800000, r);
+  uint32_t nan = pa.isNaN | pb.isNaN | (anyInf & anyZero);
+  return sfSel(nan, sfNaN, r);
+}
+
+// Fused multiply-add: a * b + c with a single rounding
+INLINE uint32_t sfFMA(uint32_t a, uint32_t b, uint32_t c) {
+  SoftFloatParts pa = sfUnpack(a), pb = sfUnpack(b), pc = sfUnpack(c);
+  uint32_t sp = pa.sign ^ pb.sign, sc = pc.sign;
+
+  // Product, normalised to have its leading one in bit 47
+  uint64_t prod = (uint64_t) pa.man * pb.man;
+  uint32_t top = prod >> 47;
+  prod = sfSel64(top, prod, prod << 1);
+  int32_t ep = (int32_t) pa.exp + (int32_t) pb.exp - 127 + (int32_t) top;
+
+  // Addend, likewise
+  uint64_t mc = (uint64_t) pc.man << 24;
+  int32_t ec = pc.exp;
+
+  // Order by exponent, so that x has the larger one
+  // (When the addend is zero, the product is always x)
+  uint32_t swap = (ec > ep) & (pc.isZero ^ 1);
+  uint32_t sx = sfSel(swap, sc, sp), sy = sfSel(swap, sp, sc);
+  int32_t ex = sfSel(swap, ec, ep);
+  uint32_t d = sfSel(swap, ec - ep, ep - ec);
+  uint64_t x = sfSel64(swap, mc, prod) << 3;
+  uint64_t y = sfSel64(swap, prod, mc) << 3;
+
+  // Align and add (or subtract) significands
+  y = sfShiftRightSticky64(y, d);
+  uint32_t sub = sx ^ sy;
+  uint64_t diff = x - y;
+  uint32_t neg = sub & (uint32_t) (diff >> 63);
+  uint64_t subMask = -(uint64_t) sub;
+  uint64_t negMask = -(uint64_t) neg;
+  uint64_t sum = (x + (y ^ subMask)) + sub;
+  sum = (sum ^ negMask) + neg;
+  uint32_t sign = sfSel(neg, sy, sx);
+
+  // Normalise (leading one to bit 63) and round
+  uint32_t lz = sfClz64(sum);
+  uint64_t n = sfShiftLeft64(sum, lz);
+  uint32_t sig = (uint32_t) (n >> 32) | ((uint32_t) n != 0);
+  uint32_t r = sfRoundPack(sign, ex + 13 - (int32_t) lz, sig);
+  r = sfSel(sum == 0, 0, r);
+
+  // Zero product: result is the addend, or a zero whose sign is
+  // negative only when both zeros are
+  uint32_t prodZero = pa.isZero | pb.isZero;
+  r = sfSel(prodZero, sfSel(pc.isZero, (sp & sc) << 31, c), r);
+
+  // Special cases
+  uint32_t prodInf = pa.isInf | pb.isInf;
+  r = sfSel(pc.isInf, (sc << 31) | 0x7f800000, r);
+  r = sfSel(prodInf, (sp << 31) | 0x7f800000, r);
+  uint32_t nan = pa.isNaN | pb.isNaN | pc.isNaN | (prodInf & prodZero) |
+                 (prodInf & pc.isInf & (sp ^ sc));
+  return sfSel(nan, sfNaN, r);
+}
+
+// Comparisons
+// ===========
+
+// Map to integers with the same ordering (for non-NaN operands)
+INLINE int32_t sfOrderKey(uint32_t x) {
+  return (int32_t) (x ^ ((uint32_t) ((int32_t) x >> 31) >> 1));
+}
+
+INLINE bool sfEq(uint32_t a, uint32_t b) {
+  SoftFloatParts pa = sfUnpack(a), pb = sfUnpack(b);
+  uint32_t ordered = (pa.isNaN | pb.isNaN) ^ 1;
+  return ordered & ((a == b) | (pa.isZero & pb.isZero));
+}
+
+INLINE bool sfLt(uint32_t a, uint32_t b) {
+  SoftFloatParts pa = sfUnpack(a), pb = sfUnpack(b);
+  uint32_t ordered = (pa.isNaN | pb.isNaN) ^ 1;
+  uint32_t bothZero = pa.isZero & pb.isZero;
+  return ordered & (bothZero ^ 1) & (sfOrderKey(a) < sfOrderKey(b));
+}
+
+INLINE bool sfLe(uint32_t a, uint32_t b) {
+  SoftFloatParts pa = sfUnpack(a), pb = sfUnpack(b);
+  uint32_t ordered = (pa.isNaN | pb.isNaN) ^ 1;
+  uint32_t bothZero = pa.isZero & pb.isZero;
+  return ordered & (bothZero | (sfOrderKey(a) <= sfOrderKey(b)));
+}
+
+// Conversions
+// ===========
+
+// Signed integer to float
+INLINE uint32_t sfFromInt(int32_t x) {
+  uint32_t sign = (uint32_t) x >> 31;
+  uint32_t mag = ((uint32_t) x ^ -sign) + sign;
+  uint32_t lz = sfClz(mag);
+  uint32_t r = sfRoundPack(sign, 158 - (int32_t) lz, mag << (lz & 31));
+  return sfSel(mag == 0, 0, r);
+}
+
+// Float to signed integer, rounding towards zero and saturating
+// (NaN converts to the largest integer)
+INLINE int32_t sfToInt(uint32_t a) {
+  SoftFloatParts p = sfUnpack(a);
+  int32_t e = p.exp;
+  uint32_t left = e >= 150;
+  uint32_t mag = sfSel(left, p.man << sfMin(e - 150, 7),
+                             p.man >> sfMin(150 - e, 31));
+  uint32_t r = (mag ^ -p.sign) + p.sign;
+  uint32_t sat = (e >= 158) | p.isNaN;
+  uint32_t satVal = sfSel(p.sign & (p.isNaN ^ 1), 0x80000000, 0x7fffffff);
+  return (int32_t) sfSel(sat, satVal, r);
+}
+
+// Float type
+// ==========
+
+// Drop-in replacement for float in kernels, using the routines above
+struct SoftFloat {
+  uint32_t bits;
+
+  SoftFloat() {}
+  SoftFloat(int x) : bits(sfFromInt(x)) {}
+
+  // Take the bit pattern of a float constant (no arithmetic needed)
+  SoftFloat(float x) { __builtin_memcpy(&bits, &x, 4); }
+
+  static SoftFloat fromBits(uint32_t x) { SoftFloat r; r.bits = x; return r; }
+
+  explicit operator int() const { return sfToInt(bits); }
+
+  SoftFloat operator-() const { return fromBits(bits ^ 0x80000000); }
+  SoftFloat& operator+=(SoftFloat x) { bits = sfAdd(bits, x.bits); return *this; }
+  SoftFloat& operator-=(SoftFloat x) { bits = sfSub(bits, x.bits); return *this; }
+  SoftFloat& operator*=(SoftFloat x) { bits = sfMul(bits, x.bits); return *this; }
+};
+
+INLINE SoftFloat operator+(SoftFloat a, SoftFloat b)
+  { return SoftFloat::fromBits(sfAdd(a.bits, b.bits)); }
+INLINE SoftFloat operator-(SoftFloat a, SoftFloat b)
+  { return SoftFloat::fromBits(sfSub(a.bits, b.bits)); }
+INLINE SoftFloat operator*(SoftFloat a, SoftFloat b)
+  { return SoftFloat::fromBits(sfMul(a.bits, b.bits)); }
+INLINE bool operator==(SoftFloat a, SoftFloat b) { return sfEq(a.bits, b.bits); }
+INLINE bool operator!=(SoftFloat a, SoftFloat b) { return !sfEq(a.bits, b.bits); }
+INLINE bool operator<(SoftFloat a, SoftFloat b) { return sfLt(a.bits, b.bits); }
+INLINE bool operator<=(SoftFloat a, SoftFloat b) { return sfLe(a.bits, b.bits); }
+INLINE bool operator>(SoftFloat a, SoftFloat b) { return sfLt(b.bits, a.bits); }
+INLINE bool operator>=(SoftFloat a, SoftFloat b) { return sfLe(b.bits, a.bits); }
+
+// Fused multiply-add: a * b + c with a single rounding
+INLINE SoftFloat sfFMA(SoftFloat a, SoftFloat b, SoftFloat c) {
+  return SoftFloat::fromBits(sfFMA(a.bits, b.bits, c.bits));
+}
+
+#endif
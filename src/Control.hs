@@ -0,0 +1,60 @@
+-- SoC-level control registers
+
+module Control where
+
+-- SoC configuration
+#include <Config.h>
+#include <SoCCtrl.h>
+
+-- Blarney imports
+import Blarney
+import Blarney.Stream
+import Blarney.PulseWire
+import Blarney.SourceSink
+
+-- Pebbles imports
+import Pebbles.Pipeline.SIMT.Management
+
+-- | Intercept SIMT management instruction-write requests that target
+-- the SoC control window, and use them to write control registers
+-- (see SoCCtrl.h).  All other requests are forwarded to the SIMT
+-- core.  Returns the current value of each control register, and a
+-- pulse for each register that is high in the cycle it is written
+-- (the new value is visible from the following cycle).
+makeSoCCtrlUnit ::
+     -- | Number of control registers
+     Int
+     -- | Management requests from CPU
+  -> Stream SIMTReq
+     -- | Management requests to SIMT core, control register values,
+     -- and write pulses
+  -> Module (Stream SIMTReq, [Bit 32], [Bit 1])
+makeSoCCtrlUnit numRegs reqs = do
+  -- Control registers
+  regs :: [Reg (Bit 32)] <- mapM (const (makeReg 0)) [1..numRegs]
+
+  -- Pulsed when each register is written
+  writes :: [PulseWire] <- mapM (const makePulseWire) [1..numRegs]
+
+  -- Is given request a control register write?
+  let isCtrlWrite req =
+        req.simtReqCmd .==. simtCmd_WriteInstr .&&.
+          req.simtReqAddr .>=. SOC_CTRL_BASE
+
+  always do
+    when (reqs.canPeek .&&. isCtrlWrite (reqs.peek)) do
+      reqs.consume
+      let regId = slice @15 @2 (reqs.peek.simtReqAddr)
+      sequence_
+        [ when (regId .==. fromIntegral i) do
+            r <== reqs.peek.simtReqData
+            w.pulse
+        | (r, w, i) <- zip3 regs writes [0..] ]
+
+  -- Forward requests to SIMT core, except those served here
+  let reqsToCore =
+        reqs {
+          canPeek = reqs.canPeek .&&. inv (isCtrlWrite (reqs.peek))
+        }
+
+  return (reqsToCore, [r.val | r <- regs], [w.val | w <- writes])
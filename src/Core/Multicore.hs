@@ -0,0 +1,82 @@
+-- Management of multiple SIMT cores
+
+module Core.Multicore where
+
+-- SoC configuration
+#include <Config.h>
+
+-- Blarney imports
+import Blarney
+import Blarney.Queue
+import Blarney.Stream
+import Blarney.SourceSink
+
+-- Pebbles imports
+import Pebbles.Pipeline.SIMT.Management
+
+-- | Id of the SIMT pipeline's cycle-count stat
+-- (Must match STAT_SIMT_CYCLES in Pebbles/CSRs/SIMTHost.h)
+simtStatCycles :: Integer
+simtStatCycles = 0
+
+-- | Broadcast SIMT management requests to several SIMT cores, and
+-- combine their responses into one.  Every core sees the same
+-- sequence of requests (instruction writes, kernel parameters, kernel
+-- starts, stat requests), so every core produces the same sequence
+-- of responses.  Responses are combined once all cores have
+-- responded: kernel completion codes and cycle counts are combined
+-- using max (the kernel finishes when the slowest core finishes);
+-- all other stats are summed.
+makeSIMTMgmtFanout ::
+     -- | Number of cores
+     Int
+     -- | Management requests from CPU
+  -> Stream SIMTReq
+     -- | Management responses from each core
+  -> [Stream SIMTResp]
+     -- | Management requests to each core, and combined responses
+  -> Module ([Stream SIMTReq], Stream SIMTResp)
+makeSIMTMgmtFanout numCores reqs resps = do
+  -- Request queue per core
+  reqQueues :: [Queue SIMTReq] <- mapM (const makeQueue) [1..numCores]
+
+  -- For each request awaiting responses, combine using max?
+  -- (Requests that don't produce a response also have an entry,
+  -- which is discarded by the response side)
+  pendingQueue :: Queue (Bit 1, Bit 1) <- makeSizedQueue 2
+
+  -- Combined responses
+  respQueue :: Queue SIMTResp <- makeQueue
+
+  -- Does request produce a response?
+  let hasResp req =
+        req.simtReqCmd .==. simtCmd_StartPipeline .||.
+          req.simtReqCmd .==. simtCmd_AskStats
+
+  -- Combine responses using max?
+  let useMax req =
+        req.simtReqCmd .==. simtCmd_StartPipeline .||.
+          req.simtReqData .==. fromInteger simtStatCycles
+
+  always do
+    -- Broadcast request
+    when (reqs.canPeek .&&. andList [q.notFull | q <- reqQueues]
+                       .&&. pendingQueue.notFull) do
+      reqs.consume
+      sequence_ [q.enq reqs.peek | q <- reqQueues]
+      pendingQueue.enq (hasResp reqs.peek, useMax reqs.peek)
+
+    -- Discard entries for requests without responses
+    when (pendingQueue.notEmpty .&&. inv pendingQueue.first.fst) do
+      pendingQueue.deq
+
+    -- Combine responses
+    when (pendingQueue.notEmpty .&&. pendingQueue.first.fst .&&.
+            andList [r.canPeek | r <- resps] .&&. respQueue.notFull) do
+      pendingQueue.deq
+      sequence_ [r.consume | r <- resps]
+      let vals = [r.peek | r <- resps]
+      let maxVal = foldr1 (\a b -> a .>. b ? (a, b)) vals
+      respQueue.enq (pendingQueue.first.snd ? (maxVal, sum vals))
+
+  return ([toStream q | q <- reqQueues], toStream respQueue)
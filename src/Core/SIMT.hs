@@ -35,11 +35,20 @@ import Pebbles.Instructions.Units.MulUnit
 import Pebbles.Instructions.Units.DivUnit
 import Pebbles.Instructions.Custom.SIMT
 
+-- SIMTight imports
+import Instructions.MAC
+import Instructions.PackedSIMD
+import Instructions.Zb
+import Instructions.Zicond
+import Instructions.Zfinx
+import Instructions.SharedDivUnit
+
 -- CHERI imports
 import CHERI.CapLib
 
 -- Haskell imports
 import Data.List
+import Data.Maybe
 import Numeric (showHex)
 
 -- Execute stage
@@ -52,12 +61,17 @@ data SIMTExecuteIns =
     -- ^ Lane id
   , execWarpId :: Bit SIMTLogWarps
     -- ^ Warp id
+  , execHartBase :: Bit 32
+    -- ^ Hart id of first thread in core
   , execKernelAddr :: Bit 32
     -- ^ Kernel address
   , execWarpCmd :: Wire WarpCmd
     -- ^ Wire containing warp command
   , execMemUnit :: MemUnit InstrInfo
     -- ^ Memory unit interface for lane
+  , execDivReqs :: Sink DivReq
+  , execDivResps :: Stream ResumeReq
+    -- ^ Interface to shared divider pool (if enabled)
   } deriving (Generic, Interface)
 
 -- | Execute stage for a SIMT lane (synthesis boundary)
@@ -66,24 +80,56 @@ makeSIMTExecuteStage ::
      -- ^ Enable CHERI?
   -> Maybe Int
      -- ^ Use intel divider? (If so, what is its latency?)
+  -> Bool
+     -- ^ Use shared divider pool (rather than a divider per lane)?
+  -> Bool
+     -- ^ Enable multiply-accumulate instruction?
+  -> Bool
+     -- ^ Enable packed SIMD instructions?
+  -> Bool
+     -- ^ Enable bit-manipulation extensions (Zba and Zbb)?
+  -> Bool
+     -- ^ Enable conditional operations extension (Zicond)?
+  -> Bool
+     -- ^ Enable floating point in integer registers (Zfinx)?
   -> SIMTExecuteIns -> State -> Module ExecuteStage
-makeSIMTExecuteStage enCHERI useFullDiv =
+makeSIMTExecuteStage enCHERI useFullDiv useSharedDiv enMAC enPacked
+                     enZb enZicond enZfinx =
   makeBoundary "SIMTExecuteStage" \ins s -> do
     -- Multiplier per vector lane
     mulUnit <- makeFullMulUnit
 
-    -- Divider per vector lane
+    -- Divider per vector lane, or interface to shared divider pool
     divUnit <-
-      case useFullDiv of
-        Nothing -> makeSeqDivUnit
-        Just latency -> makeFullDivUnit latency
+      if useSharedDiv
+        then return DivUnit { divReqs = ins.execDivReqs
+                            , divResps = ins.execDivResps }
+        else case useFullDiv of
+               Nothing -> makeSeqDivUnit
+               Just latency -> makeFullDivUnit latency
+
+    -- Optional multiply-accumulate unit per vector lane
+    macUnit <- if enMAC then Just <$> makeMACUnit else return Nothing
+
+    -- Optional dot-product unit per vector lane (for packed SIMD)
+    dotUnit <- if enPacked then Just <$> makeDotUnit else return Nothing
+
+    -- Optional floating-point units per vector lane
+    fpUnits <-
+      if enZfinx
+        then do
+          fpUnit <- makeFPUnit
+          fdivUnit <- makeFDivUnit
+          return (Just (fpUnit, fdivUnit))
+        else return Nothing
 
     -- SIMT warp control CSRs
     csr_WarpCmd <- makeCSR_WarpCmd (ins.execLaneId) (ins.execWarpCmd)
     csr_WarpGetKernel <- makeCSR_WarpGetKernel (ins.execKernelAddr)
 
     -- CSR unit
-    let hartId = zeroExtend (ins.execWarpId # ins.execLaneId)
+    let hartId = ins.execHartBase +
+                   zeroExtend (ins.execWarpId # ins.execLaneId)
     csrUnit <- makeCSRUnit $
          csrs_Sim
       ++ [csr_HartId hartId]
@@ -105,9 +151,15 @@ makeSIMTExecuteStage enCHERI useFullDiv =
       (ins.execMemUnit.memResps)
 
     -- Merge resume requests
-    let resumeReqStream =
+    let resumeReqStream0 =
           memResumeReqs `mergeTwo`
             mergeTwo (mulUnit.mulResps) (divUnit.divResps)
+    let resumeReqStream =
+          foldl mergeTwo resumeReqStream0
+            (  [unit.unitResps | Just unit <- [macUnit]]
+            ++ [unit.unitResps | Just unit <- [dotUnit]]
+            ++ concat [ [fpUnit.unitResps, fdivUnit.unitResps]
+                      | Just (fpUnit, fdivUnit) <- [fpUnits] ] )
 
     -- Resume queue
     resumeQueue <- makePipelineQueue 1
@@ -118,6 +170,19 @@ makeSIMTExecuteStage enCHERI useFullDiv =
         execute = do
           executeI (Just mulUnit) csrUnit memReqSink s
           executeM mulUnit divUnit s
+          if enZb
+            then do executeZba s; executeZbb s
+            else return ()
+          if enZicond then executeZicond s else return ()
+          case macUnit of
+            Nothing -> return ()
+            Just unit -> executeMAC unit s
+          case dotUnit of
+            Nothing -> return ()
+            Just unit -> executePackedSIMD unit s
+          case fpUnits of
+            Nothing -> return ()
+            Just (fpUnit, fdivUnit) -> executeZfinx fpUnit fdivUnit s
           if enCHERI
             then executeCHERI csrUnit capMemReqSink s
             else do
@@ -149,24 +214,48 @@ data SIMTCoreConfig =
   , simtCoreUseFullDivider :: Maybe Int
     -- ^ Use full throughput divider?
     -- (If so, what latency? If not, slow seq divider used)
+  , simtCoreSharedDividers :: Maybe (Int, Int)
+    -- ^ Share a pool of full-throughput dividers between lanes?
+    -- (If so, how many dividers, and what latency? Overrides the above)
+  , simtCoreEnableMAC :: Bool
+    -- ^ Enable multiply-accumulate custom instruction?
+  , simtCoreEnablePackedSIMD :: Bool
+    -- ^ Enable packed 8-bit and 16-bit SIMD custom instructions?
+  , simtCoreEnableZb :: Bool
+    -- ^ Enable bit-manipulation extensions (Zba and Zbb)?
+  , simtCoreEnableZicond :: Bool
+    -- ^ Enable conditional operations extension (Zicond)?
+  , simtCoreEnableZfinx :: Bool
+    -- ^ Enable floating point in integer registers (Zfinx)?
   }
 
 -- | RV32IM SIMT core
 makeSIMTCore ::
      -- | Configuration parameters
      SIMTCoreConfig
+     -- | Hart id of first thread in core
+  -> Bit 32
      -- | SIMT management requests
   -> Stream SIMTReq
      -- | Memory unit per vector lane
   -> Vec SIMTLanes (MemUnit InstrInfo)
      -- | SIMT management responses
   -> Module (Stream SIMTResp)
-makeSIMTCore config mgmtReqs memUnitsVec = mdo
+makeSIMTCore config hartBase mgmtReqs memUnitsVec = mdo
   let memUnits = toList memUnitsVec
 
   -- Apply stack address interleaving
   let memUnits' = interleaveStacks memUnits
 
+  -- Optional pool of dividers shared between lanes
+  divUnits <-
+    case config.simtCoreSharedDividers of
+      Nothing -> return [ DivUnit { divReqs = nullSink
+                                  , divResps = nullSource }
+                        | _ <- memUnits ]
+      Just (numDivs, latency) ->
+        makeSharedDivUnits numDivs latency SIMTLanes
+
   -- Wire for warp command
   warpCmdWire :: Wire WarpCmd <- makeWire dontCare
 
@@ -183,6 +272,12 @@ makeSIMTCore config mgmtReqs memUnitsVec = mdo
         , checkPCCFunc =
             if config.simtCoreEnableCHERI then Just checkPCC else Nothing
         , useExtraPreExecStage = config.simtCoreUseExtraPreExecStage
+#if SIMTEnableMAC || SIMTEnablePackedSIMD || EnableZfinx
+          -- Third register operand (rs3) needed by custom instructions
+        , useThirdOperand = config.simtCoreEnableMAC ||
+                              config.simtCoreEnablePackedSIMD ||
+                                config.simtCoreEnableZfinx
+#endif
         , decodeStage = concat
             [ decodeI
             , if config.simtCoreEnableCHERI
@@ -193,19 +288,35 @@ makeSIMTCore config mgmtReqs memUnitsVec = mdo
                 then decodeCHERI_A
                 else decodeA
             , decodeSIMT
+            , if config.simtCoreEnableZb then decodeZba ++ decodeZbb else []
+            , if config.simtCoreEnableZicond then decodeZicond else []
+            , if config.simtCoreEnableZfinx then decodeZfinx else []
+            , if config.simtCoreEnableMAC then decodeMAC else []
+            , if config.simtCoreEnablePackedSIMD
+                then decodePackedSIMD
+                else []
             ]
         , executeStage =
             [ makeSIMTExecuteStage
                 (config.simtCoreEnableCHERI)
                 (config.simtCoreUseFullDivider)
+                (isJust config.simtCoreSharedDividers)
+                (config.simtCoreEnableMAC)
+                (config.simtCoreEnablePackedSIMD)
+                (config.simtCoreEnableZb)
+                (config.simtCoreEnableZicond)
+                (config.simtCoreEnableZfinx)
                 SIMTExecuteIns {
                   execLaneId = fromInteger i
                 , execWarpId = pipelineOuts.simtCurrentWarpId.truncate
+                , execHartBase = hartBase
                 , execKernelAddr = pipelineOuts.simtKernelAddr
                 , execWarpCmd = warpCmdWire
                 , execMemUnit = memUnit
+                , execDivReqs = divUnit.divReqs
+                , execDivResps = divUnit.divResps
                 }
-            | (memUnit, i) <- zip memUnits' [0..] ]
+            | (memUnit, divUnit, i) <- zip3 memUnits' divUnits [0..] ]
         , simtPushTag = SIMT_PUSH
         , simtPopTag = SIMT_POP
         }
@@ -221,6 +332,7 @@ makeSIMTCore config mgmtReqs memUnitsVec = mdo
 
 -- | Stack address interleaver so that accesses to same stack
 -- offset by different threads in a warp are coalesced
+-- (The stacks region holds a stack for every thread in every core)
 interleaveStacks :: [MemUnit id] -> [MemUnit id]
 interleaveStacks memUnits =
     [ memUnit {
@@ -237,8 +349,10 @@ interleaveStacks memUnits =
         then top # stackOffset # stackId # wordOffset
         else a
       where
-        top = slice @31 @(SIMTLogWarps+SIMTLogLanes+SIMTLogBytesPerStack) a
-        stackId = slice @(SIMTLogWarps+SIMTLogLanes+SIMTLogBytesPerStack-1)
+        top = slice @31 @(SIMTLogCores+SIMTLogWarps+SIMTLogLanes+
+                            SIMTLogBytesPerStack) a
+        stackId = slice @(SIMTLogCores+SIMTLogWarps+SIMTLogLanes+
+                            SIMTLogBytesPerStack-1)
                         @SIMTLogBytesPerStack a
         stackOffset = slice @(SIMTLogBytesPerStack-1) @2 a
         wordOffset = slice @1 @0 a
@@ -2,6 +2,9 @@
 
 module Core.Scalar where
 
+-- SoC configuration
+#include <Config.h>
+
 -- Blarney imports
 import Blarney
 import Blarney.Stream
@@ -28,6 +31,11 @@ import Pebbles.Instructions.Custom.CacheManagement
 import Pebbles.Memory.Interface
 import Pebbles.Memory.DRAM.Interface
 
+-- SIMTight imports
+import Instructions.Zb
+import Instructions.Zicond
+import Instructions.Zfinx
+
 -- CHERI imports
 import CHERI.CapLib
 
@@ -49,6 +57,12 @@ data ScalarCoreConfig =
     -- ^ Enable CHERI extensions
   , scalarCoreCapRegInitFile :: Maybe String
     -- ^ File containing initial capability register file (meta-data only)
+  , scalarCoreEnableZb :: Bool
+    -- ^ Enable bit-manipulation extensions (Zba and Zbb)
+  , scalarCoreEnableZicond :: Bool
+    -- ^ Enable conditional operations extension (Zicond)
+  , scalarCoreEnableZfinx :: Bool
+    -- ^ Enable floating point in integer registers (Zfinx)
   }
 
 -- | Scalar core inputs
@@ -110,6 +124,15 @@ makeScalarCore config inputs = mdo
   -- Divider
   divUnit <- makeSeqDivUnit
 
+  -- Optional floating-point units
+  fpUnits <-
+    if config.scalarCoreEnableZfinx
+      then do
+        fpUnit <- makeFPUnit
+        fdivUnit <- makeFDivUnit
+        return (Just (fpUnit, fdivUnit))
+      else return Nothing
+
   -- Memory requests from core
   (memReqSink, capMemReqSink) <-
     if config.scalarCoreEnableCHERI
@@ -132,12 +155,19 @@ makeScalarCore config inputs = mdo
     , enableRegForwarding = config.scalarCoreEnableRegForwarding
     , initialPC = config.scalarCoreInitialPC
     , capRegInitFile = config.scalarCoreCapRegInitFile
+#if EnableZfinx
+      -- Third register operand (rs3) needed by fused multiply-add
+    , useThirdOperand = config.scalarCoreEnableZfinx
+#endif
     , decodeStage = concat
         [ decodeI
         , if config.scalarCoreEnableCHERI then [] else decodeI_NoCap
         , decodeM
         , decodeCacheMgmt
         , if config.scalarCoreEnableCHERI then decodeCHERI else []
+        , if config.scalarCoreEnableZb then decodeZba ++ decodeZbb else []
+        , if config.scalarCoreEnableZicond then decodeZicond else []
+        , if config.scalarCoreEnableZfinx then decodeZfinx else []
         ]
     , executeStage = \s -> return
         ExecuteStage {
@@ -145,14 +175,25 @@ makeScalarCore config inputs = mdo
             executeI Nothing csrUnit memReqSink s
             executeM mulUnit divUnit s
             executeCacheMgmt memReqSink s
+            if config.scalarCoreEnableZb
+              then do executeZba s; executeZbb s
+              else return ()
+            if config.scalarCoreEnableZicond
+              then executeZicond s
+              else return ()
+            case fpUnits of
+              Nothing -> return ()
+              Just (fpUnit, fdivUnit) -> executeZfinx fpUnit fdivUnit s
             if config.scalarCoreEnableCHERI
               then executeCHERI csrUnit capMemReqSink s
               else executeI_NoCap csrUnit memReqSink s
-        , resumeReqs = mergeTree
+        , resumeReqs = mergeTree $
             [ memResumeReqs
             , mulUnit.mulResps
             , divUnit.divResps
-            ]
+            ] ++
+            concat [ [fpUnit.unitResps, fdivUnit.unitResps]
+                   | Just (fpUnit, fdivUnit) <- [fpUnits] ]
         }
     , trapCSRs = trapRegs
     , checkPCCFunc =
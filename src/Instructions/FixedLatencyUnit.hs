@@ -0,0 +1,81 @@
+-- Fixed-latency, full-throughput functional unit for custom instructions
+
+module Instructions.FixedLatencyUnit where
+
+-- Blarney imports
+import Blarney
+import Blarney.Queue
+import Blarney.Stream
+import Blarney.PulseWire
+import Blarney.SourceSink
+
+-- Pebbles imports
+import Pebbles.Pipeline.Interface
+
+-- | Functional unit interface
+data FixedLatencyUnit req =
+  FixedLatencyUnit {
+    unitReqs :: Sink (InstrInfo, req)
+    -- ^ Requests, with instruction info used to resume the thread
+  , unitResps :: Stream ResumeReq
+    -- ^ Results, as pipeline resume requests
+  }
+
+-- | Full-throughput unit computing the given function, with the given
+-- latency.  The function is followed by a chain of registers, which
+-- synthesis can retime into the logic (e.g. into DSP blocks).
+-- Requests are only accepted when there is room in the result queue
+-- for every request in flight, so the chain never needs to stall.
+makeFixedLatencyUnit :: Bits req =>
+  Int -> (req -> Bit 32) -> Module (FixedLatencyUnit req)
+makeFixedLatencyUnit latency f = do
+  -- Results, with room for every request in flight
+  resultQueue :: Queue ResumeReq <- makeSizedQueue 3
+
+  -- Number of requests in flight or in result queue
+  inflight :: Reg (Bit 4) <- makeReg 0
+
+  -- Requests in and results out
+  reqWire :: Wire (InstrInfo, req) <- makeWire dontCare
+  consumed <- makePulseWire
+
+  -- Function, followed by pipeline registers
+  let (info, req) = reqWire.val
+  let stages = iterate (\(v, x) -> (delay false v, delay dontCare x))
+                       (reqWire.active, (info, f req))
+  let (outValid, (outInfo, outResult)) = stages !! latency
+
+  always do
+    when outValid do
+      resultQueue.enq
+        ResumeReq {
+          resumeReqInfo = outInfo
+        , resumeReqData = outResult
+        , resumeReqCap = none
+        }
+
+    inflight <== inflight.val + zeroExtend reqWire.active
+                              - zeroExtend consumed.val
+
+  return
+    FixedLatencyUnit {
+      unitReqs =
+        Sink {
+          canPut = inflight.val .<. 8
+        , put = \r -> reqWire <== r
+        }
+    , unitResps =
+        (toStream resultQueue) {
+          consume = do resultQueue.deq; consumed.pulse
+        }
+    }
+
+-- | Issue request to unit from execute stage, suspending the thread
+-- until the result is ready (or retrying if the unit is busy)
+issueToUnit :: FixedLatencyUnit req -> State -> req -> Action ()
+issueToUnit unit s req =
+  if unit.unitReqs.canPut
+    then do
+      info <- s.suspend
+      unit.unitReqs.put (info, req)
+    else s.retry
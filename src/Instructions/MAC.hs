@@ -0,0 +1,68 @@
+-- Integer multiply-accumulate custom instruction for SIMT lanes
+
+module Instructions.MAC where
+
+-- SoC configuration
+#include <Config.h>
+
+-- Blarney imports
+import Blarney
+
+-- Pebbles imports
+import Pebbles.Pipeline.Interface
+import Pebbles.Instructions.Mnemonics
+
+-- SIMTight imports
+import Instructions.FixedLatencyUnit
+
+-- Decode stage
+-- ============
+
+-- | Multiply-accumulate, in R4 format using the custom-0 opcode:
+-- mac rd, rs1, rs2, rs3 computes rd = rs1 * rs2 + rs3 (lower 32 bits)
+-- (The MAC mnemonic and the third register operand are only present
+-- in pebbles builds supporting SIMTEnableMAC)
+#if SIMTEnableMAC
+decodeMAC =
+  [ "rs3<5> 00 rs2<5> rs1<5> 000 rd<5> 0001011" --> MAC
+  ]
+#else
+decodeMAC = []
+#endif
+
+-- MAC unit
+-- ========
+
+-- | Latency of MAC unit (registers after the multiply-add)
+macLatency :: Int
+macLatency = 3
+
+-- | MAC unit operands (computing A * B + C)
+data MACOperands =
+  MACOperands {
+    macA :: Bit 32
+  , macB :: Bit 32
+  , macC :: Bit 32
+  }
+  deriving (Generic, Bits)
+
+-- | Full-throughput MAC unit
+type MACUnit = FixedLatencyUnit MACOperands
+
+makeMACUnit :: Module MACUnit
+makeMACUnit =
+  makeFixedLatencyUnit macLatency \ops -> ops.macA * ops.macB + ops.macC
+
+-- Execute stage
+-- =============
+
+-- | Execute multiply-accumulate instruction
+executeMAC :: MACUnit -> State -> Action ()
+#if SIMTEnableMAC
+executeMAC macUnit s = do
+  when (s.opcode `is` [MAC]) do
+    issueToUnit macUnit s
+      MACOperands { macA = s.opA, macB = s.opB, macC = s.opC }
+#else
+executeMAC macUnit s = return ()
+#endif
@@ -0,0 +1,195 @@
+-- Packed 8-bit and 16-bit SIMD-within-a-register custom instructions
+
+module Instructions.PackedSIMD where
+
+-- SoC configuration
+#include <Config.h>
+
+-- Blarney imports
+import Blarney
+
+-- Pebbles imports
+import Pebbles.Pipeline.Interface
+import Pebbles.Instructions.Mnemonics
+
+-- SIMTight imports
+import Instructions.FixedLatencyUnit
+
+-- Decode stage
+-- ============
+
+-- | Packed instructions use the custom-1 opcode.  Element-wise
+-- operations are R-type, with funct3 selecting the element size
+-- (000 for 4x8-bit, 001 for 2x16-bit) and funct7 the operation.
+-- Dot-product-accumulate operations are R4-type: rd = rs3 + the sum
+-- of the element-wise products of rs1 and rs2.  (The mnemonics and
+-- the third register operand are only present in pebbles builds
+-- supporting SIMTEnablePackedSIMD.)
+#if SIMTEnablePackedSIMD
+decodePackedSIMD =
+  [ "0000000 rs2<5> rs1<5> 000 rd<5> 0101011" --> ADD8
+  , "0000000 rs2<5> rs1<5> 001 rd<5> 0101011" --> ADD16
+  , "0000001 rs2<5> rs1<5> 000 rd<5> 0101011" --> SUB8
+  , "0000001 rs2<5> rs1<5> 001 rd<5> 0101011" --> SUB16
+  , "0000010 rs2<5> rs1<5> 000 rd<5> 0101011" --> SMIN8
+  , "0000010 rs2<5> rs1<5> 001 rd<5> 0101011" --> SMIN16
+  , "0000011 rs2<5> rs1<5> 000 rd<5> 0101011" --> SMAX8
+  , "0000011 rs2<5> rs1<5> 001 rd<5> 0101011" --> SMAX16
+  , "0000100 rs2<5> rs1<5> 000 rd<5> 0101011" --> UMIN8
+  , "0000100 rs2<5> rs1<5> 001 rd<5> 0101011" --> UMIN16
+  , "0000101 rs2<5> rs1<5> 000 rd<5> 0101011" --> UMAX8
+  , "0000101 rs2<5> rs1<5> 001 rd<5> 0101011" --> UMAX16
+  , "0000110 rs2<5> rs1<5> 000 rd<5> 0101011" --> KADD8
+  , "0000110 rs2<5> rs1<5> 001 rd<5> 0101011" --> KADD16
+  , "0000111 rs2<5> rs1<5> 000 rd<5> 0101011" --> KSUB8
+  , "0000111 rs2<5> rs1<5> 001 rd<5> 0101011" --> KSUB16
+  , "0001000 rs2<5> rs1<5> 000 rd<5> 0101011" --> UKADD8
+  , "0001000 rs2<5> rs1<5> 001 rd<5> 0101011" --> UKADD16
+  , "0001001 rs2<5> rs1<5> 000 rd<5> 0101011" --> UKSUB8
+  , "0001001 rs2<5> rs1<5> 001 rd<5> 0101011" --> UKSUB16
+  , "rs3<5> 00 rs2<5> rs1<5> 010 rd<5> 0101011" --> SMAQA8
+  , "rs3<5> 00 rs2<5> rs1<5> 011 rd<5> 0101011" --> UMAQA8
+  , "rs3<5> 00 rs2<5> rs1<5> 100 rd<5> 0101011" --> SMAQA16
+  , "rs3<5> 00 rs2<5> rs1<5> 101 rd<5> 0101011" --> UMAQA16
+  ]
+#else
+decodePackedSIMD = []
+#endif
+
+-- Element-wise operations
+-- =======================
+
+-- | Split word into 8-bit elements (least significant first)
+bytes :: Bit 32 -> [Bit 8]
+bytes x = [slice @7 @0 x, slice @15 @8 x, slice @23 @16 x, slice @31 @24 x]
+
+-- | Split word into 16-bit elements (least significant first)
+halves :: Bit 32 -> [Bit 16]
+halves x = [slice @15 @0 x, slice @31 @16 x]
+
+-- | Apply operator to each pair of 8-bit elements
+lanewise8 :: (Bit 8 -> Bit 8 -> Bit 8) -> Bit 32 -> Bit 32 -> Bit 32
+lanewise8 f a b = r3 # r2 # r1 # r0
+  where [r0, r1, r2, r3] = zipWith f (bytes a) (bytes b)
+
+-- | Apply operator to each pair of 16-bit elements
+lanewise16 :: (Bit 16 -> Bit 16 -> Bit 16) -> Bit 32 -> Bit 32 -> Bit 32
+lanewise16 f a b = r1 # r0
+  where [r0, r1] = zipWith f (halves a) (halves b)
+
+-- | Is element negative (when viewed as signed)?
+isNeg :: forall n. KnownNat n => Bit n -> Bit 1
+isNeg x = x .>=. fromInteger (2 ^ (valueOf @n - 1))
+
+-- | Signed less-than
+slt :: forall n. KnownNat n => Bit n -> Bit n -> Bit 1
+slt x y = (x .^. msb) .<. (y .^. msb)
+  where msb = fromInteger (2 ^ (valueOf @n - 1))
+
+-- | Signed saturation value, given sign of overflowed result
+satSigned :: forall n. KnownNat n => Bit 1 -> Bit n
+satSigned neg =
+  neg ? (fromInteger (2 ^ (valueOf @n - 1)),
+         fromInteger (2 ^ (valueOf @n - 1) - 1))
+
+-- | Signed saturating add
+addSat :: KnownNat n => Bit n -> Bit n -> Bit n
+addSat x y = overflow ? (satSigned (isNeg x), r)
+  where
+    r = x + y
+    overflow = isNeg x .==. isNeg y .&&. isNeg r .!=. isNeg x
+
+-- | Signed saturating subtract
+subSat :: KnownNat n => Bit n -> Bit n -> Bit n
+subSat x y = overflow ? (satSigned (isNeg x), r)
+  where
+    r = x - y
+    overflow = isNeg x .!=. isNeg y .&&. isNeg r .!=. isNeg x
+
+-- | Unsigned saturating add
+addSatU :: KnownNat n => Bit n -> Bit n -> Bit n
+addSatU x y = r .<. x ? (ones, r) where r = x + y
+
+-- | Unsigned saturating subtract
+subSatU :: KnownNat n => Bit n -> Bit n -> Bit n
+subSatU x y = x .<. y ? (0, x - y)
+
+#if SIMTEnablePackedSIMD
+-- | Element-wise operations, for each element size
+packedOps :: [(Mnemonic, Bit 32 -> Bit 32 -> Bit 32)]
+packedOps =
+  [ (ADD8, lanewise8 (+)), (ADD16, lanewise16 (+))
+  , (SUB8, lanewise8 (-)), (SUB16, lanewise16 (-))
+  , (SMIN8, lanewise8 \x y -> slt x y ? (x, y))
+  , (SMIN16, lanewise16 \x y -> slt x y ? (x, y))
+  , (SMAX8, lanewise8 \x y -> slt x y ? (y, x))
+  , (SMAX16, lanewise16 \x y -> slt x y ? (y, x))
+  , (UMIN8, lanewise8 \x y -> x .<. y ? (x, y))
+  , (UMIN16, lanewise16 \x y -> x .<. y ? (x, y))
+  , (UMAX8, lanewise8 \x y -> x .<. y ? (y, x))
+  , (UMAX16, lanewise16 \x y -> x .<. y ? (y, x))
+  , (KADD8, lanewise8 addSat), (KADD16, lanewise16 addSat)
+  , (KSUB8, lanewise8 subSat), (KSUB16, lanewise16 subSat)
+  , (UKADD8, lanewise8 addSatU), (UKADD16, lanewise16 addSatU)
+  , (UKSUB8, lanewise8 subSatU), (UKSUB16, lanewise16 subSatU)
+  ]
+#endif
+
+-- Dot-product-accumulate unit
+-- ===========================
+
+-- | Latency of dot-product unit (registers after the multiply-adds)
+dotLatency :: Int
+dotLatency = 3
+
+-- | Dot-product unit operands
+data DotOperands =
+  DotOperands {
+    dotIsSigned :: Bit 1
+    -- ^ Are elements signed?
+  , dotIs16 :: Bit 1
+    -- ^ Are elements 16-bit (rather than 8-bit)?
+  , dotA :: Bit 32
+  , dotB :: Bit 32
+    -- ^ Packed elements to multiply
+  , dotC :: Bit 32
+    -- ^ Accumulator
+  }
+  deriving (Generic, Bits)
+
+-- | Full-throughput dot-product unit
+type DotUnit = FixedLatencyUnit DotOperands
+
+makeDotUnit :: Module DotUnit
+makeDotUnit = makeFixedLatencyUnit dotLatency \ops ->
+  let ext :: KnownNat n => Bit n -> Bit 32
+      ext x = ops.dotIsSigned ? (signExtend x, zeroExtend x)
+      dot8 = sum [ext x * ext y | (x, y) <- zip (bytes ops.dotA)
+                                                (bytes ops.dotB)]
+      dot16 = sum [ext x * ext y | (x, y) <- zip (halves ops.dotA)
+                                                 (halves ops.dotB)]
+  in  ops.dotC + (ops.dotIs16 ? (dot16, dot8))
+
+-- Execute stage
+-- =============
+
+-- | Execute packed SIMD instructions
+executePackedSIMD :: DotUnit -> State -> Action ()
+#if SIMTEnablePackedSIMD
+executePackedSIMD dotUnit s = do
+  sequence_
+    [ when (s.opcode `is` [m]) do s.result <== f s.opA s.opB
+    | (m, f) <- packedOps ]
+
+  when (s.opcode `is` [SMAQA8, UMAQA8, SMAQA16, UMAQA16]) do
+    issueToUnit dotUnit s
+      DotOperands {
+        dotIsSigned = s.opcode `is` [SMAQA8, SMAQA16]
+      , dotIs16 = s.opcode `is` [SMAQA16, UMAQA16]
+      , dotA = s.opA
+      , dotB = s.opB
+      , dotC = s.opC
+      }
+#else
+executePackedSIMD dotUnit s = return ()
+#endif
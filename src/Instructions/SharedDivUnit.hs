@@ -0,0 +1,98 @@
+-- Pool of full-throughput dividers shared by the lanes of a SIMT core
+
+module Instructions.SharedDivUnit where
+
+-- Blarney imports
+import Blarney
+import Blarney.Queue
+import Blarney.Stream
+import Blarney.SourceSink
+
+-- Pebbles imports
+import Pebbles.Pipeline.Interface
+import Pebbles.Instructions.Units.DivUnit
+
+-- | A middle ground between a sequential divider per lane (small but
+-- slow) and a full-throughput divider per lane (fast but large).
+-- Each divider in the pool serves a fixed group of lanes (lane i is
+-- served by divider i mod numDivs), and a round-robin arbiter issues
+-- one request per cycle from the group.  Results are returned to each
+-- lane as resume requests, just like a per-lane divider.
+makeSharedDivUnits ::
+     Int
+     -- ^ Number of dividers in pool (should divide number of lanes)
+  -> Int
+     -- ^ Latency of each divider
+  -> Int
+     -- ^ Number of lanes
+  -> Module [DivUnit]
+     -- ^ Divider interface per lane
+makeSharedDivUnits numDivs latency numLanes = do
+  -- Request and response queues per lane
+  reqQueues :: [Queue DivReq] <- mapM (const makeQueue) [1..numLanes]
+  respQueues :: [Queue ResumeReq] <- mapM (const makeQueue) [1..numLanes]
+
+  -- One divider per group of lanes
+  sequence_
+    [ makeDivGroup latency [reqQueues !! i | i <- group]
+                           [respQueues !! i | i <- group]
+    | g <- [0..numDivs-1]
+    , let group = [g, g+numDivs .. numLanes-1] ]
+
+  -- The active lanes of a warp put their requests in the same cycle,
+  -- and if any lane cannot, the whole warp is retried later.  So a
+  -- request is accepted from one lane only if it can be accepted from
+  -- all of them, otherwise a retry would issue some divisions twice.
+  let canPutAll = andList [q.notFull | q <- reqQueues]
+
+  return
+    [ DivUnit {
+        divReqs = Sink { canPut = canPutAll, put = q.enq }
+      , divResps = toStream r
+      }
+    | (q, r) <- zip reqQueues respQueues ]
+
+-- | Full-throughput divider shared by a group of lanes
+makeDivGroup :: Int -> [Queue DivReq] -> [Queue ResumeReq] -> Module ()
+makeDivGroup latency reqQueues respQueues = do
+  divUnit <- makeFullDivUnit latency
+
+  -- Lane (index within group) of each request in flight.  The divider
+  -- is pipelined, so results emerge in the order requests were issued.
+  laneQueue :: Queue (Bit 8) <- makeSizedQueue 6
+
+  -- Lane (index within group) whose request was issued most recently
+  lastLane :: Reg (Bit 8) <- makeReg 0
+
+  always do
+    -- Issue request from the first lane with one waiting, searching
+    -- round-robin from the lane after the one last served, so that
+    -- no lane can be starved under sustained load
+    let n = length reqQueues
+    let dist :: Int -> Bit 8
+        dist i = (fromIntegral i .>. lastLane.val) ?
+                   ( fromIntegral i - lastLane.val
+                   , fromIntegral (i + n) - lastLane.val )
+    let avail = [q.notEmpty | q <- reqQueues]
+    let chosen = [ a .&&. andList [ inv b .||. dist j .>. dist i
+                                  | (b, j) <- zip avail [0..], j /= i ]
+                 | (a, i) <- zip avail [0..] ]
+    when (orList avail .&&. divUnit.divReqs.canPut
+                       .&&. laneQueue.notFull) do
+      sequence_ [when c do q.deq | (c, q) <- zip chosen reqQueues]
+      divUnit.divReqs.put (select (zip chosen [q.first | q <- reqQueues]))
+      let chosenLane = select (zip chosen (map fromIntegral [0 .. n-1]))
+      laneQueue.enq chosenLane
+      lastLane <== chosenLane
+
+    -- Return result to the lane that requested it
+    let lane = laneQueue.first
+    let isLane i = lane .==. fromInteger i
+    let canReturn = orList [isLane i .&&. r.notFull
+                           | (r, i) <- zip respQueues [0..]]
+    when (divUnit.divResps.canPeek .&&. canReturn) do
+      divUnit.divResps.consume
+      laneQueue.deq
+      sequence_
+        [ when (isLane i) do r.enq divUnit.divResps.peek
+        | (r, i) <- zip respQueues [0..] ]
@@ -0,0 +1,134 @@
+-- RISC-V bit-manipulation extensions: Zba (address generation) and
+-- Zbb (basic bit manipulation), for RV32
+
+module Instructions.Zb where
+
+-- SoC configuration
+#include <Config.h>
+
+-- Blarney imports
+import Blarney
+
+-- Pebbles imports
+import Pebbles.Pipeline.Interface
+import Pebbles.Instructions.Mnemonics
+
+-- Decode stage
+-- ============
+
+-- (The mnemonics are only present in pebbles builds supporting EnableZb)
+#if EnableZb
+decodeZba =
+  [ "0010000 rs2<5> rs1<5> 010 rd<5> 0110011" --> SH1ADD
+  , "0010000 rs2<5> rs1<5> 100 rd<5> 0110011" --> SH2ADD
+  , "0010000 rs2<5> rs1<5> 110 rd<5> 0110011" --> SH3ADD
+  ]
+
+decodeZbb =
+  [ "0100000 rs2<5> rs1<5> 111 rd<5> 0110011" --> ANDN
+  , "0100000 rs2<5> rs1<5> 110 rd<5> 0110011" --> ORN
+  , "0100000 rs2<5> rs1<5> 100 rd<5> 0110011" --> XNOR
+  , "0110000 00000 rs1<5> 001 rd<5> 0010011" --> CLZ
+  , "0110000 00001 rs1<5> 001 rd<5> 0010011" --> CTZ
+  , "0110000 00010 rs1<5> 001 rd<5> 0010011" --> CPOP
+  , "0000101 rs2<5> rs1<5> 110 rd<5> 0110011" --> MAX
+  , "0000101 rs2<5> rs1<5> 111 rd<5> 0110011" --> MAXU
+  , "0000101 rs2<5> rs1<5> 100 rd<5> 0110011" --> MIN
+  , "0000101 rs2<5> rs1<5> 101 rd<5> 0110011" --> MINU
+  , "0110000 00100 rs1<5> 001 rd<5> 0010011" --> SEXT_B
+  , "0110000 00101 rs1<5> 001 rd<5> 0010011" --> SEXT_H
+  , "0000100 00000 rs1<5> 100 rd<5> 0110011" --> ZEXT_H
+  , "0110000 rs2<5> rs1<5> 001 rd<5> 0110011" --> ROL
+  , "0110000 rs2<5> rs1<5> 101 rd<5> 0110011" --> ROR
+  , "0110000 imm[4:0] rs1<5> 101 rd<5> 0010011" --> RORI
+  , "001010000111 rs1<5> 101 rd<5> 0010011" --> ORC_B
+  , "011010011000 rs1<5> 101 rd<5> 0010011" --> REV8
+  ]
+#else
+decodeZba = []
+decodeZbb = []
+#endif
+
+-- Helpers
+-- =======
+
+-- | Split word into bytes (least significant first)
+wordBytes :: Bit 32 -> [Bit 8]
+wordBytes x =
+  [slice @7 @0 x, slice @15 @8 x, slice @23 @16 x, slice @31 @24 x]
+
+-- | Signed less-than
+lessThanSigned :: Bit 32 -> Bit 32 -> Bit 1
+lessThanSigned x y = (x .^. 0x80000000) .<. (y .^. 0x80000000)
+
+-- | Rotate right
+rotateRight :: Bit 32 -> Bit 5 -> Bit 32
+rotateRight x n = truncate ((x # x) .>>. (zeroExtend n :: Bit 64))
+
+-- | Count leading zeros.  Each term checks that the top i+1 bits are
+-- zero; the terms are summed by an adder tree.
+countLeadingZeros :: Bit 32 -> Bit 32
+countLeadingZeros x =
+  sum [ zeroExtend (x .>>. (fromInteger (31 - i) :: Bit 5) .==. 0)
+      | i <- [0..31] ]
+
+-- | Count trailing zeros (likewise, checking the bottom i+1 bits)
+countTrailingZeros :: Bit 32 -> Bit 32
+countTrailingZeros x =
+  sum [ zeroExtend (x .<<. (fromInteger (31 - i) :: Bit 5) .==. 0)
+      | i <- [0..31] ]
+
+-- | Population count
+countOnes :: Bit 32 -> Bit 32
+countOnes x = sum [zeroExtend b | b <- toBitList x]
+
+-- Execute stage
+-- =============
+
+executeZba :: State -> Action ()
+executeZbb :: State -> Action ()
+#if EnableZb
+executeZba s = do
+  let shiftAdd :: Bit 5 -> Bit 32
+      shiftAdd n = (s.opA .<<. n) + s.opB
+  when (s.opcode `is` [SH1ADD]) do s.result <== shiftAdd 1
+  when (s.opcode `is` [SH2ADD]) do s.result <== shiftAdd 2
+  when (s.opcode `is` [SH3ADD]) do s.result <== shiftAdd 3
+
+executeZbb s = do
+  let a = s.opA
+  let b = s.opB
+  let lt = lessThanSigned a b
+  let ltu = a .<. b
+  when (s.opcode `is` [ANDN]) do s.result <== a .&. inv b
+  when (s.opcode `is` [ORN]) do s.result <== a .|. inv b
+  when (s.opcode `is` [XNOR]) do s.result <== inv (a .^. b)
+  when (s.opcode `is` [CLZ]) do s.result <== countLeadingZeros a
+  when (s.opcode `is` [CTZ]) do s.result <== countTrailingZeros a
+  when (s.opcode `is` [CPOP]) do s.result <== countOnes a
+  when (s.opcode `is` [MAX]) do s.result <== lt ? (b, a)
+  when (s.opcode `is` [MAXU]) do s.result <== ltu ? (b, a)
+  when (s.opcode `is` [MIN]) do s.result <== lt ? (a, b)
+  when (s.opcode `is` [MINU]) do s.result <== ltu ? (a, b)
+  when (s.opcode `is` [SEXT_B]) do
+    s.result <== signExtend (slice @7 @0 a)
+  when (s.opcode `is` [SEXT_H]) do
+    s.result <== signExtend (slice @15 @0 a)
+  when (s.opcode `is` [ZEXT_H]) do
+    s.result <== zeroExtend (slice @15 @0 a)
+  when (s.opcode `is` [ROL]) do
+    s.result <== rotateRight a (0 - slice @4 @0 b)
+  when (s.opcode `is` [ROR]) do
+    s.result <== rotateRight a (slice @4 @0 b)
+  when (s.opcode `is` [RORI]) do
+    s.result <== rotateRight a (slice @4 @0 s.immOrOpB)
+  when (s.opcode `is` [ORC_B]) do
+    s.result <== let [b0, b1, b2, b3] =
+                       [x .!=. 0 ? (ones, 0) | x <- wordBytes a] :: [Bit 8]
+                 in  b3 # b2 # b1 # b0
+  when (s.opcode `is` [REV8]) do
+    s.result <== let [b0, b1, b2, b3] = wordBytes a in b0 # b1 # b2 # b3
+#else
+executeZba s = return ()
+executeZbb s = return ()
+#endif
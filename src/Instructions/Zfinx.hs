@@ -0,0 +1,512 @@
+-- Single-precision floating point in integer registers (Zfinx)
+--
+-- Zfinx provides the RV32F computational instructions, but operating
+-- on the integer register file, so no separate floating-point register
+-- file (nor flw/fsw/fmv) is needed.  Simplifications:
+--
+--   * subnormal inputs and results are flushed to zero (preserving sign);
+--   * NaN results are always the canonical NaN;
+--   * the rounding mode is taken from the instruction; the dynamic mode
+--     means round-to-nearest-even, as there is no fcsr;
+--   * exception flags are not recorded.
+
+module Instructions.Zfinx where
+
+-- SoC configuration
+#include <Config.h>
+
+-- Blarney imports
+import Blarney
+import Blarney.Queue
+import Blarney.Stream
+import Blarney.SourceSink
+
+-- Pebbles imports
+import Pebbles.Pipeline.Interface
+import Pebbles.Instructions.Mnemonics
+
+-- SIMTight imports
+import Instructions.FixedLatencyUnit
+
+-- Decode stage
+-- ============
+
+-- (The mnemonics and the third register operand are only present in
+-- pebbles builds supporting EnableZfinx)
+#if EnableZfinx
+decodeZfinx =
+  [ "rs3<5> 00 rs2<5> rs1<5> rm<3> rd<5> 1000011" --> FMADD_S
+  , "rs3<5> 00 rs2<5> rs1<5> rm<3> rd<5> 1000111" --> FMSUB_S
+  , "rs3<5> 00 rs2<5> rs1<5> rm<3> rd<5> 1001011" --> FNMSUB_S
+  , "rs3<5> 00 rs2<5> rs1<5> rm<3> rd<5> 1001111" --> FNMADD_S
+  , "0000000 rs2<5> rs1<5> rm<3> rd<5> 1010011" --> FADD_S
+  , "0000100 rs2<5> rs1<5> rm<3> rd<5> 1010011" --> FSUB_S
+  , "0001000 rs2<5> rs1<5> rm<3> rd<5> 1010011" --> FMUL_S
+  , "0001100 rs2<5> rs1<5> rm<3> rd<5> 1010011" --> FDIV_S
+  , "0101100 00000 rs1<5> rm<3> rd<5> 1010011" --> FSQRT_S
+  , "0010000 rs2<5> rs1<5> 000 rd<5> 1010011" --> FSGNJ_S
+  , "0010000 rs2<5> rs1<5> 001 rd<5> 1010011" --> FSGNJN_S
+  , "0010000 rs2<5> rs1<5> 010 rd<5> 1010011" --> FSGNJX_S
+  , "0010100 rs2<5> rs1<5> 000 rd<5> 1010011" --> FMIN_S
+  , "0010100 rs2<5> rs1<5> 001 rd<5> 1010011" --> FMAX_S
+  , "1100000 00000 rs1<5> rm<3> rd<5> 1010011" --> FCVT_W_S
+  , "1100000 00001 rs1<5> rm<3> rd<5> 1010011" --> FCVT_WU_S
+  , "1010000 rs2<5> rs1<5> 010 rd<5> 1010011" --> FEQ_S
+  , "1010000 rs2<5> rs1<5> 001 rd<5> 1010011" --> FLT_S
+  , "1010000 rs2<5> rs1<5> 000 rd<5> 1010011" --> FLE_S
+  , "1110000 00000 rs1<5> 001 rd<5> 1010011" --> FCLASS_S
+  , "1101000 00000 rs1<5> rm<3> rd<5> 1010011" --> FCVT_S_W
+  , "1101000 00001 rs1<5> rm<3> rd<5> 1010011" --> FCVT_S_WU
+  ]
+#else
+decodeZfinx = []
+#endif
+
+-- Helpers
+-- =======
+
+-- | Rounding modes
+rne, rtz, rdn, rup, rmm :: Bit 3
+rne = 0; rtz = 1; rdn = 2; rup = 3; rmm = 4
+
+-- | Rounding mode of instruction (dynamic and reserved modes mean RNE)
+roundingMode :: Bit 32 -> Bit 3
+roundingMode instr = rm .>. rmm ? (rne, rm)
+  where rm = slice @14 @12 instr
+
+-- | Canonical NaN
+canonicalNaN :: Bit 32
+canonicalNaN = 0x7fc00000
+
+-- | Unpacked float
+data Unpacked =
+  Unpacked {
+    fpSign :: Bit 1
+  , fpExp :: Bit 8
+  , fpMan :: Bit 24
+    -- ^ Mantissa including hidden bit (zero if float is zero)
+  , fpIsZero :: Bit 1
+    -- ^ Zero or subnormal (flushed to zero)
+  , fpIsInf :: Bit 1
+  , fpIsNaN :: Bit 1
+  }
+
+unpackFloat :: Bit 32 -> Unpacked
+unpackFloat x =
+  Unpacked {
+    fpSign = slice @31 @31 x
+  , fpExp = e
+  , fpMan = isZero ? (0, 1 # f)
+  , fpIsZero = isZero
+  , fpIsInf = e .==. ones .&&. f .==. 0
+  , fpIsNaN = e .==. ones .&&. f .!=. 0
+  }
+  where
+    e = slice @30 @23 x
+    f = slice @22 @0 x
+    isZero = e .==. 0
+
+-- | Should magnitude be incremented when rounding?  Takes the rounding
+-- mode, sign, least significant bit kept, guard bit, and sticky bit.
+roundInc :: Bit 3 -> Bit 1 -> Bit 1 -> Bit 1 -> Bit 1 -> Bit 1
+roundInc rm sign lsb g st =
+  rm .==. rtz ? (0,
+  rm .==. rdn ? (inexact .&. sign,
+  rm .==. rup ? (inexact .&. inv sign,
+  rm .==. rmm ? (g, g .&. (st .|. lsb)))))
+  where inexact = g .|. st
+
+-- | Round and pack a float, given the rounding mode, sign, exponent,
+-- mantissa (with leading one at bit 23), guard bit, and sticky bit.
+-- Exponents are biased by 127+256, so that intermediate values never
+-- go negative.  Results too small for a normal float flush to zero.
+roundPack :: Bit 3 -> Bit 1 -> Bit 11 -> Bit 24 -> Bit 1 -> Bit 1 -> Bit 32
+roundPack rm sign e man g st =
+  overflow ? (sign # (toInf ? (0x7f800000, 0x7f7fffff)),
+  underflow ? (sign # 0, sign # slice @7 @0 e' # slice @22 @0 m))
+  where
+    inc = roundInc rm sign (slice @0 @0 man) g st
+    m25 :: Bit 25 = zeroExtend man + zeroExtend inc
+    carry = slice @24 @24 m25
+    m = carry ? (slice @24 @1 m25, slice @23 @0 m25)
+    e' = e + zeroExtend carry
+    overflow = e' .>=. 511
+    underflow = e' .<=. 256
+    toInf = rm .==. rne .||. rm .==. rmm .||.
+              (rm .==. rdn .&&. sign) .||. (rm .==. rup .&&. inv sign)
+
+-- | Shift left until top bit is set (input must be non-zero),
+-- returning shifted value and shift amount
+normalise :: Bit 52 -> (Bit 52, Bit 6)
+normalise x = foldl step (x, 0) [32, 16, 8, 4, 2, 1]
+  where
+    step (v, k) n =
+      let z = (v .>>. (fromInteger (52 - n) :: Bit 6)) .==. 0
+      in  ( z ? (v .<<. (fromInteger n :: Bit 6), v)
+          , z ? (k + fromInteger n, k) )
+
+-- | Shift right, ORing the bits shifted out into the least significant bit
+shiftRightSticky :: forall n. KnownNat n => Bit n -> Bit 11 -> Bit n
+shiftRightSticky x d =
+  d .>=. fromIntegral (valueOf @n) ? (zeroExtend (x .!=. 0),
+    (x .>>. d) .|. zeroExtend ((x .&. ((1 .<<. d) - 1)) .!=. 0))
+
+-- Pipelined unit
+-- ==============
+
+-- | Latency of pipelined floating-point unit
+fpuLatency :: Int
+fpuLatency = 4
+
+-- | Operations of pipelined floating-point unit
+fpOpFMA, fpOpFromInt, fpOpToInt :: Bit 2
+fpOpFMA = 0; fpOpFromInt = 1; fpOpToInt = 2
+
+-- | Pipelined floating-point unit operands
+data FPOperands =
+  FPOperands {
+    fpOp :: Bit 2
+    -- ^ Operation
+  , fpRM :: Bit 3
+    -- ^ Rounding mode
+  , fpA :: Bit 32
+  , fpB :: Bit 32
+  , fpC :: Bit 32
+    -- ^ Operands (computing A * B + C, or converting A)
+  , fpNegProd :: Bit 1
+  , fpNegC :: Bit 1
+    -- ^ Negate product and/or C
+  , fpIsMul :: Bit 1
+    -- ^ Plain multiply (C is -0 but doesn't affect the sign of zero)
+  , fpSigned :: Bit 1
+    -- ^ Is integer signed (for conversions)?
+  }
+  deriving (Generic, Bits)
+
+-- | Fused multiply-add with a single rounding.  Add, subtract, and
+-- multiply are special cases: a + c = a * 1.0 + c, a * b = a * b + -0.
+fusedMulAdd :: FPOperands -> Bit 32
+fusedMulAdd ops =
+  invalid ? (canonicalNaN,
+  prodInf ? (sp # 0x7f800000,
+  c.fpIsInf ? (sc # 0x7f800000,
+  prodZero ? (c.fpIsZero ? (zeroSign # 0, sc # slice @30 @0 ops.fpC),
+  c.fpIsZero ? (prodOnly, sumResult)))))
+  where
+    rm = ops.fpRM
+    a = unpackFloat ops.fpA
+    b = unpackFloat ops.fpB
+    c = unpackFloat ops.fpC
+    sp = a.fpSign .^. b.fpSign .^. ops.fpNegProd
+    sc = c.fpSign .^. ops.fpNegC
+    prodInf = a.fpIsInf .||. b.fpIsInf
+    prodZero = a.fpIsZero .||. b.fpIsZero
+    invalid = a.fpIsNaN .||. b.fpIsNaN .||. c.fpIsNaN .||.
+                (prodInf .&&. prodZero) .||.
+                  (prodInf .&&. c.fpIsInf .&&. sp .!=. sc)
+
+    -- Sign of exact zero result
+    zeroSign = ops.fpIsMul ? (sp, sp .==. sc ? (sp, rm .==. rdn))
+
+    -- Exact product, with leading one moved to bit 47
+    prod :: Bit 48 = zeroExtend a.fpMan * zeroExtend b.fpMan
+    prodTop = slice @47 @47 prod
+    mp = prodTop ? (prod, slice @46 @0 prod # (0 :: Bit 1))
+    ep :: Bit 11 = zeroExtend a.fpExp + zeroExtend b.fpExp + 129
+                     + zeroExtend prodTop
+    prodOnly = roundPack rm sp ep (slice @47 @24 mp) (slice @23 @23 mp)
+                 (slice @22 @0 mp .!=. 0)
+
+    -- Addend, with leading one at bit 47
+    mc :: Bit 48 = c.fpMan # (0 :: Bit 24)
+    ec :: Bit 11 = zeroExtend c.fpExp + 256
+
+    -- Align operand with smaller exponent (keeping 3 extra bits)
+    swap = ec .>. ep
+    ex = swap ? (ec, ep)
+    d = swap ? (ec - ep, ep - ec)
+    sx = swap ? (sc, sp)
+    sy = swap ? (sp, sc)
+    x :: Bit 51 = (swap ? (mc, mp)) # (0 :: Bit 3)
+    y :: Bit 51 = shiftRightSticky ((swap ? (mp, mc)) # (0 :: Bit 3)) d
+
+    -- Add or subtract magnitudes
+    xGEy = x .>=. y
+    s :: Bit 52 = sx .==. sy ? (zeroExtend x + zeroExtend y,
+                                zeroExtend (xGEy ? (x - y, y - x)))
+    sign = (sx .==. sy .||. xGEy) ? (sx, sy)
+
+    -- Normalise and round
+    (n, k) = normalise s
+    sumResult =
+      s .==. 0 ? ((rm .==. rdn) # 0,
+        roundPack rm sign (ex + 1 - zeroExtend k) (slice @51 @28 n)
+          (slice @27 @27 n) (slice @26 @0 n .!=. 0))
+
+-- | Convert integer to float
+floatFromInt :: Bit 3 -> Bit 1 -> Bit 32 -> Bit 32
+floatFromInt rm isSigned x =
+  mag .==. 0 ? (0,
+    roundPack rm sign (414 - zeroExtend k) (slice @51 @28 n)
+      (slice @27 @27 n) (slice @26 @0 n .!=. 0))
+  where
+    sign = isSigned .&. slice @31 @31 x
+    mag = sign ? (0 - x, x)
+    (n, k) = normalise (mag # (0 :: Bit 20))
+
+-- | Convert float to integer (saturating on overflow and NaN)
+intFromFloat :: Bit 3 -> Bit 1 -> Bit 32 -> Bit 32
+intFromFloat rm isSigned x =
+  a.fpIsNaN ? (maxVal,
+  e .>=. 159 ? (a.fpSign ? (minVal, maxVal),
+  a.fpIsZero ? (0,
+  isSigned ? (a.fpSign ? (r .>. 0x80000000 ? (minVal, truncate (0 - r)),
+                          r .>. 0x7fffffff ? (maxVal, truncate r)),
+              a.fpSign ? (0, r .>. 0xffffffff ? (maxVal, truncate r))))))
+  where
+    a = unpackFloat x
+    e :: Bit 11 = zeroExtend a.fpExp
+    -- Fixed-point value with 32 fractional bits
+    m :: Bit 64 = zeroExtend a.fpMan
+    w = e .>=. 118 ? (m .<<. (e - 118), shiftRightSticky m (118 - e))
+    int = slice @63 @32 w
+    inc = roundInc rm a.fpSign (slice @32 @32 w) (slice @31 @31 w)
+            (slice @30 @0 w .!=. 0)
+    r :: Bit 33 = zeroExtend int + zeroExtend inc
+    maxVal = isSigned ? (0x7fffffff, 0xffffffff)
+    minVal = isSigned ? (0x80000000, 0)
+
+-- | Full-throughput floating-point unit
+type FPUnit = FixedLatencyUnit FPOperands
+
+makeFPUnit :: Module FPUnit
+makeFPUnit = makeFixedLatencyUnit fpuLatency \ops ->
+  ops.fpOp .==. fpOpFromInt ? (floatFromInt ops.fpRM ops.fpSigned ops.fpA,
+  ops.fpOp .==. fpOpToInt ? (intFromFloat ops.fpRM ops.fpSigned ops.fpA,
+    fusedMulAdd ops))
+
+-- Division and square root unit
+-- =============================
+
+-- | Divide/sqrt unit operands
+data FDivOperands =
+  FDivOperands {
+    fdivIsSqrt :: Bit 1
+  , fdivRM :: Bit 3
+  , fdivA :: Bit 32
+  , fdivB :: Bit 32
+  }
+  deriving (Generic, Bits)
+
+-- | Sequential divide/sqrt unit, producing one result bit per cycle
+-- using restoring division and digit-by-digit square root (it shares
+-- the request/response interface of the fixed-latency units)
+type FDivUnit = FixedLatencyUnit FDivOperands
+
+makeFDivUnit :: Module FDivUnit
+makeFDivUnit = do
+  -- Results
+  resultQueue :: Queue ResumeReq <- makeQueue
+
+  -- State of operation in progress
+  busy :: Reg (Bit 1) <- makeReg 0
+  count :: Reg (Bit 5) <- makeReg dontCare
+  info :: Reg InstrInfo <- makeReg dontCare
+  isSqrt :: Reg (Bit 1) <- makeReg dontCare
+  rm :: Reg (Bit 3) <- makeReg dontCare
+  sign :: Reg (Bit 1) <- makeReg dontCare
+  expo :: Reg (Bit 11) <- makeReg dontCare
+  special :: Reg (Bit 1) <- makeReg dontCare
+  specialVal :: Reg (Bit 32) <- makeReg dontCare
+  -- Partial remainder, quotient (or root), divisor, and radicand
+  remainder :: Reg (Bit 30) <- makeReg dontCare
+  quotient :: Reg (Bit 27) <- makeReg dontCare
+  divisor :: Reg (Bit 24) <- makeReg dontCare
+  radicand :: Reg (Bit 50) <- makeReg dontCare
+
+  always do
+    -- Compute one result bit
+    when (busy.val .&&. count.val .!=. 0) do
+      count <== count.val - 1
+      if isSqrt.val
+        then do
+          let r = (remainder.val .<<. (2 :: Bit 2))
+                    .|. zeroExtend (slice @49 @48 radicand.val)
+          let trial = zeroExtend (quotient.val # (1 :: Bit 2))
+          let bit = r .>=. trial
+          remainder <== bit ? (r - trial, r)
+          quotient <== truncate (quotient.val # bit)
+          radicand <== radicand.val .<<. (2 :: Bit 2)
+        else do
+          let bit = remainder.val .>=. zeroExtend divisor.val
+          let r = bit ? (remainder.val - zeroExtend divisor.val,
+                         remainder.val)
+          remainder <== r .<<. (1 :: Bit 1)
+          quotient <== truncate (quotient.val # bit)
+
+    -- Round and return result
+    when (busy.val .&&. count.val .==. 0 .&&. resultQueue.notFull) do
+      busy <== 0
+      let q = quotient.val
+      let top = slice @26 @26 q
+      let sticky = remainder.val .!=. 0
+      let divResult =
+            roundPack rm.val sign.val (top ? (expo.val, expo.val - 1))
+              (top ? (slice @26 @3 q, slice @25 @2 q))
+              (top ? (slice @2 @2 q, slice @1 @1 q))
+              ((top ? (slice @1 @0 q .!=. 0, slice @0 @0 q)) .|. sticky)
+      let sqrtResult =
+            roundPack rm.val 0 expo.val (slice @24 @1 q) (slice @0 @0 q)
+              sticky
+      resultQueue.enq
+        ResumeReq {
+          resumeReqInfo = info.val
+        , resumeReqData =
+            special.val ? (specialVal.val,
+              isSqrt.val ? (sqrtResult, divResult))
+        , resumeReqCap = none
+        }
+
+  return
+    FixedLatencyUnit {
+      unitReqs =
+        Sink {
+          canPut = inv busy.val
+        , put = \(reqInfo, ops) -> do
+            let a = unpackFloat ops.fdivA
+            let b = unpackFloat ops.fdivB
+            let s = a.fpSign .^. b.fpSign
+            busy <== 1
+            info <== reqInfo
+            isSqrt <== ops.fdivIsSqrt
+            rm <== ops.fdivRM
+            remainder <== ops.fdivIsSqrt ? (0, zeroExtend a.fpMan)
+            quotient <== 0
+            divisor <== b.fpMan
+            -- Shift mantissa so that the exponent of the radicand is even
+            radicand <== zeroExtend a.fpMan .<<.
+              (slice @23 @23 ops.fdivA ? (25 :: Bit 5, 26))
+            if ops.fdivIsSqrt
+              then do
+                count <== 25
+                sign <== 0
+                expo <== ((zeroExtend a.fpExp + 127) .>>. (1 :: Bit 1)) + 256
+                special <== a.fpIsNaN .||. a.fpIsZero .||. a.fpIsInf
+                              .||. a.fpSign
+                specialVal <==
+                  (a.fpIsNaN .||. (a.fpSign .&&. inv a.fpIsZero)) ?
+                    (canonicalNaN,
+                     a.fpIsZero ? (a.fpSign # 0, 0x7f800000))
+              else do
+                count <== 27
+                sign <== s
+                expo <== zeroExtend a.fpExp - zeroExtend b.fpExp + 383
+                special <== a.fpIsNaN .||. b.fpIsNaN .||. a.fpIsInf
+                              .||. a.fpIsZero .||. b.fpIsInf .||. b.fpIsZero
+                specialVal <==
+                  (a.fpIsNaN .||. b.fpIsNaN .||. (a.fpIsInf .&&. b.fpIsInf)
+                    .||. (a.fpIsZero .&&. b.fpIsZero)) ? (canonicalNaN,
+                  (a.fpIsInf .||. b.fpIsZero) ? (s # 0x7f800000, s # 0))
+        }
+    , unitResps = toStream resultQueue
+    }
+
+-- Execute stage
+-- =============
+
+-- | Execute Zfinx instructions
+executeZfinx :: FPUnit -> FDivUnit -> State -> Action ()
+#if EnableZfinx
+executeZfinx fpUnit fdivUnit s = do
+  let rm = roundingMode s.instr
+  let a = unpackFloat s.opA
+  let b = unpackFloat s.opB
+  let anyNaN = a.fpIsNaN .||. b.fpIsNaN
+  let bothZero = a.fpIsZero .&&. b.fpIsZero
+  let magA = slice @30 @0 s.opA
+  let magB = slice @30 @0 s.opB
+  -- Ordering on non-NaN values, with -0 < +0
+  let lt = a.fpSign .!=. b.fpSign ? (a.fpSign,
+             a.fpSign ? (magA .>. magB, magA .<. magB))
+  let eq = s.opA .==. s.opB .||. bothZero
+
+  -- Sign injection
+  when (s.opcode `is` [FSGNJ_S]) do
+    s.result <== b.fpSign # magA
+  when (s.opcode `is` [FSGNJN_S]) do
+    s.result <== inv b.fpSign # magA
+  when (s.opcode `is` [FSGNJX_S]) do
+    s.result <== (a.fpSign .^. b.fpSign) # magA
+
+  -- Min and max (NaN operands are ignored unless both are NaN)
+  when (s.opcode `is` [FMIN_S, FMAX_S]) do
+    let useA = s.opcode `is` [FMIN_S] ? (lt, inv lt)
+    s.result <==
+      (a.fpIsNaN .&&. b.fpIsNaN) ? (canonicalNaN,
+      a.fpIsNaN ? (s.opB,
+      b.fpIsNaN ? (s.opA,
+      useA ? (s.opA, s.opB))))
+
+  -- Comparisons
+  when (s.opcode `is` [FEQ_S]) do
+    s.result <== zeroExtend (inv anyNaN .&&. eq)
+  when (s.opcode `is` [FLT_S]) do
+    s.result <== zeroExtend (inv anyNaN .&&. inv bothZero .&&. lt)
+  when (s.opcode `is` [FLE_S]) do
+    s.result <== zeroExtend (inv anyNaN .&&. (lt .||. eq))
+
+  -- Classification
+  when (s.opcode `is` [FCLASS_S]) do
+    let e = slice @30 @23 s.opA
+    let f = slice @22 @0 s.opA
+    let sign = a.fpSign
+    let isSub = e .==. 0 .&&. f .!=. 0
+    let isZero = e .==. 0 .&&. f .==. 0
+    let isNormal = e .!=. 0 .&&. e .!=. ones
+    let quiet = slice @22 @22 s.opA
+    -- Bit 0 is negative infinity, ..., bit 9 is quiet NaN
+    s.result <== zeroExtend (
+         (a.fpIsNaN .&&. quiet)
+      #  (a.fpIsNaN .&&. inv quiet)
+      #  (inv sign .&&. a.fpIsInf)
+      #  (inv sign .&&. isNormal)
+      #  (inv sign .&&. isSub)
+      #  (inv sign .&&. isZero)
+      #  (sign .&&. isZero)
+      #  (sign .&&. isSub)
+      #  (sign .&&. isNormal)
+      #  (sign .&&. a.fpIsInf))
+
+  -- Operations using the pipelined unit
+  let fpOps =
+        FPOperands {
+          fpOp = s.opcode `is` [FCVT_S_W, FCVT_S_WU] ? (fpOpFromInt,
+                 s.opcode `is` [FCVT_W_S, FCVT_WU_S] ? (fpOpToInt,
+                   fpOpFMA))
+        , fpRM = rm
+        , fpA = s.opA
+        , fpB = s.opcode `is` [FADD_S, FSUB_S] ? (0x3f800000, s.opB)
+        , fpC = s.opcode `is` [FADD_S, FSUB_S] ? (s.opB,
+                s.opcode `is` [FMUL_S] ? (0x80000000, s.opC))
+        , fpNegProd = s.opcode `is` [FNMSUB_S, FNMADD_S]
+        , fpNegC = s.opcode `is` [FSUB_S, FMSUB_S, FNMADD_S]
+        , fpIsMul = s.opcode `is` [FMUL_S]
+        , fpSigned = s.opcode `is` [FCVT_S_W, FCVT_W_S]
+        }
+  when (s.opcode `is` [ FADD_S, FSUB_S, FMUL_S
+                      , FMADD_S, FMSUB_S, FNMSUB_S, FNMADD_S
+                      , FCVT_S_W, FCVT_S_WU, FCVT_W_S, FCVT_WU_S ]) do
+    issueToUnit fpUnit s fpOps
+
+  -- Operations using the divide/sqrt unit
+  when (s.opcode `is` [FDIV_S, FSQRT_S]) do
+    issueToUnit fdivUnit s
+      FDivOperands {
+        fdivIsSqrt = s.opcode `is` [FSQRT_S]
+      , fdivRM = rm
+      , fdivA = s.opA
+      , fdivB = s.opB
+      }
+#else
+executeZfinx fpUnit fdivUnit s = return ()
+#endif
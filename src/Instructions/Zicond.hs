@@ -0,0 +1,44 @@
+-- RISC-V integer conditional operations extension (Zicond)
+
+module Instructions.Zicond where
+
+-- SoC configuration
+#include <Config.h>
+
+-- Blarney imports
+import Blarney
+
+-- Pebbles imports
+import Pebbles.Pipeline.Interface
+import Pebbles.Instructions.Mnemonics
+
+-- Decode stage
+-- ============
+
+-- (The mnemonics are only present in pebbles builds supporting
+-- EnableZicond)
+#if EnableZicond
+decodeZicond =
+  [ "0000111 rs2<5> rs1<5> 101 rd<5> 0110011" --> CZERO_EQZ
+  , "0000111 rs2<5> rs1<5> 111 rd<5> 0110011" --> CZERO_NEZ
+  ]
+#else
+decodeZicond = []
+#endif
+
+-- Execute stage
+-- =============
+
+-- | A conditional select (c ? a : b) compiles to a czero.eqz, a
+-- czero.nez and an or, avoiding a branch (and hence divergence)
+executeZicond :: State -> Action ()
+#if EnableZicond
+executeZicond s = do
+  let isZero = s.opB .==. 0
+  when (s.opcode `is` [CZERO_EQZ]) do
+    s.result <== isZero ? (0, s.opA)
+  when (s.opcode `is` [CZERO_NEZ]) do
+    s.result <== isZero ? (s.opA, 0)
+#else
+executeZicond s = return ()
+#endif
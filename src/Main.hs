@@ -4,6 +4,8 @@ module Main where
 
 -- SoC parameters
 #include <Config.h>
+#include <SoCCtrl.h>
+#include <SoCStats.h>
 
 -- Blarney imports
 import Blarney
@@ -31,8 +33,14 @@ import Pebbles.Pipeline.Interface
 import Pebbles.Pipeline.SIMT.Management
 
 -- SIMTight imports
+import Stats
+import Control
 import Core.SIMT
 import Core.Scalar
+import Core.Multicore
+import Memory.DMA
+import Memory.L1Cache
+import Memory.BurstMerger
 
 -- SoC top-level interface
 -- =======================
@@ -155,6 +163,9 @@ makeCPUCore = makeBoundary "CPUCore" (makeScalarCore config)
           if EnableCHERI == 1
             then Just (scalarCapRegInitFile ++ ".mif")
             else Nothing
+      , scalarCoreEnableZb = EnableZb == 1
+      , scalarCoreEnableZicond = EnableZicond == 1
+      , scalarCoreEnableZfinx = EnableZfinx == 1
       }
 
 -- CPU data cache (synthesis boundary)
@@ -168,19 +179,75 @@ makeSIMTDomain (clk, rst) =
   makeBoundaryWithClockAndReset (clk, rst) "SIMTDomain" \ins -> mdo
 
     let dramReqs0 = ins.simtDomainDRAMReqsFromCPU
-    let simtMgmtReqs = ins.simtDomainMgmtReqsFromCPU
 
-    -- SIMT core
-    simtMgmtResps <- makeSIMTAccelerator
-      simtMgmtReqs
-      simtMemUnits
-
-    -- SIMT memory subsystem
-    (simtMemUnits, dramReqs1) <- makeSIMTMemSubsystem dramResps1
-
-    -- DRAM bus
-    ((dramResps0, dramResps1), dramReqs) <-
-      makeDRAMBus (dramReqs0, dramReqs1) dramResps
+    -- SoC-level control registers
+    (simtMgmtReqs0, ctrlRegs, ctrlWrites) <-
+      makeSoCCtrlUnit SOC_CTRL_NUM_REGS (ins.simtDomainMgmtReqsFromCPU)
+    let enableL1Cache = (ctrlRegs !! SOC_CTRL_L1_ENABLE).truncate
+
+    -- Optional DMA engine
+    (dmaDRAMReqs, dmaBusy) <-
+      if EnableDMA == 1
+        then do
+          (reqs, busy) <-
+            makeDMAUnit ctrlRegs (ctrlWrites !! SOC_CTRL_DMA_START)
+                        (head dmaDRAMResps)
+          return ([reqs], busy)
+        else return ([], false)
+
+    -- SoC-level stat counters (summed over all SIMT cores)
+    let total f = sum [f m | m <- coreMemStats]
+    (simtMgmtReqs, simtMgmtResps, kernelStart) <-
+      makeSoCStatsUnit
+        [ (STAT_SOC_DRAM_LOAD_REQS,
+             total \m -> m.memStatsMerger.mergerLoadReqs)
+        , (STAT_SOC_DRAM_LOAD_BURSTS,
+             total \m -> m.memStatsMerger.mergerLoadBursts)
+        , (STAT_SOC_DRAM_LOAD_BEATS,
+             total \m -> m.memStatsMerger.mergerLoadBeats)
+        , (STAT_SOC_SRAM_LANE_REQS,
+             total \m -> m.memStatsSRAMLaneReqs)
+        , (STAT_SOC_SRAM_REQS,
+             total \m -> m.memStatsSRAM.streamItems)
+        , (STAT_SOC_SRAM_STALL_CYCLES,
+             total \m -> m.memStatsSRAM.streamStallCycles)
+        , (STAT_SOC_SRAM_MCAST_HITS,
+             total \m -> m.memStatsSRAMLaneReqs -
+                           m.memStatsSRAM.streamItems)
+        , (STAT_SOC_L1_HITS, total \m -> m.memStatsL1.l1Hits)
+        , (STAT_SOC_L1_MISSES, total \m -> m.memStatsL1.l1Misses)
+        , (STAT_SOC_DMA_BUSY, zeroExtend dmaBusy)
+        ]
+        simtMgmtReqs0
+        simtCoreMgmtResps
+
+    -- Distribute management requests over SIMT cores
+    (coreMgmtReqs, simtCoreMgmtResps) <-
+      if SIMTCores == 1
+        then return ([simtMgmtReqs], head coreMgmtResps)
+        else makeSIMTMgmtFanout SIMTCores simtMgmtReqs coreMgmtResps
+
+    -- SIMT cores
+    -- (Hart ids are unique across cores)
+    coreMgmtResps <- sequence
+      [ makeSIMTAccelerator
+          (fromInteger (i * SIMTWarps * SIMTLanes))
+          (coreMgmtReqs !! i)
+          (coreMemUnits !! i)
+      | i <- [0 .. SIMTCores-1] ]
+
+    -- SIMT memory subsystem per core
+    coreMems <- sequence
+      [ makeSIMTMemSubsystem kernelStart enableL1Cache (coreDRAMResps !! i)
+      | i <- [0 .. SIMTCores-1] ]
+    let (coreMemUnits, coreDRAMReqs, coreMemStats) = unzip3 coreMems
+
+    -- DRAM bus, shared by CPU, DMA engine and SIMT cores
+    (clientDRAMResps, dramReqs) <-
+      makeDRAMBusTree (dramReqs0 : dmaDRAMReqs ++ coreDRAMReqs) dramResps
+    let dramResps0 = head clientDRAMResps
+    let (dmaDRAMResps, coreDRAMResps) =
+          splitAt (length dmaDRAMReqs) (tail clientDRAMResps)
 
     -- Optional tag controller
     (dramResps, dramFinalReqs) <-
@@ -203,7 +270,25 @@ makeSIMTDomain (clk, rst) =
       , simtDomainDRAMRespsToCPU = dramResps0
       }
 
+-- | Tree of DRAM buses, allowing any number of clients to share DRAM
+makeDRAMBusTree ::
+     -- | DRAM requests from each client
+     [Stream (DRAMReq ())]
+     -- | DRAM responses
+  -> Stream (DRAMResp ())
+     -- | DRAM responses to each client, and DRAM requests
+  -> Module ([Stream (DRAMResp ())], Stream (DRAMReq ()))
+makeDRAMBusTree [reqs] resps = return ([resps], reqs)
+makeDRAMBusTree clients resps = mdo
+  let (left, right) = splitAt (length clients `div` 2) clients
+  (leftResps, leftReqs) <- makeDRAMBusTree left leftResps1
+  (rightResps, rightReqs) <- makeDRAMBusTree right rightResps1
+  ((leftResps1, rightResps1), reqs) <-
+    makeDRAMBus (leftReqs, rightReqs) resps
+  return (leftResps ++ rightResps, reqs)
+
 -- SIMT accelerator (synthesis boundary)
+-- Takes the hart id of its first thread as an input
 makeSIMTAccelerator = makeBoundary "SIMTAccelerator" (makeSIMTCore config)
   where
     config =
@@ -222,6 +307,15 @@ makeSIMTAccelerator = makeBoundary "SIMTAccelerator" (makeSIMTCore config)
           if SIMTUseFullDivider == 1
             then Just SIMTFullDividerLatency
             else Nothing
+      , simtCoreSharedDividers =
+          if SIMTSharedDividers > 0
+            then Just (SIMTSharedDividers, SIMTFullDividerLatency)
+            else Nothing
+      , simtCoreEnableMAC = SIMTEnableMAC == 1
+      , simtCoreEnablePackedSIMD = SIMTEnablePackedSIMD == 1
+      , simtCoreEnableZb = EnableZb == 1
+      , simtCoreEnableZicond = EnableZicond == 1
+      , simtCoreEnableZfinx = EnableZfinx == 1
       }
 
 -- SIMT memory subsystem
@@ -229,12 +323,32 @@ makeSIMTAccelerator = makeBoundary "SIMTAccelerator" (makeSIMTCore config)
 
 type SIMTMemReqId = (InstrInfo, MemReqInfo)
 
+-- | SIMT memory subsystem stats
+data SIMTMemStats =
+  SIMTMemStats {
+    memStatsMerger :: BurstMergerStats
+    -- ^ DRAM burst merger stats
+  , memStatsSRAMLaneReqs :: Bit 32
+    -- ^ Number of lane accesses to banked SRAMs (before coalescing)
+  , memStatsSRAM :: StreamStats
+    -- ^ Requests to banked SRAMs, and cycles in which a request was
+    -- stalled (by bank conflicts or response backpressure)
+  , memStatsL1 :: L1CacheStats
+    -- ^ L1 data cache hits and misses
+  }
+
 makeSIMTMemSubsystem ::
+     -- | Kernel start pulse (clears stat counters)
+     Bit 1
+     -- | Enable L1 data cache?
+  -> Bit 1
      -- | DRAM responses
-     Stream (DRAMResp ())
-     -- | DRAM requests and per-lane mem units
-  -> Module (V.Vec SIMTLanes (MemUnit InstrInfo), Stream (DRAMReq ()))
-makeSIMTMemSubsystem dramResps = mdo
+  -> Stream (DRAMResp ())
+     -- | DRAM requests, per-lane mem units, and stats
+  -> Module ( V.Vec SIMTLanes (MemUnit InstrInfo)
+            , Stream (DRAMReq ())
+            , SIMTMemStats )
+makeSIMTMemSubsystem kernelStart enableL1Cache dramResps = mdo
     -- Warp preserver
     (memReqs, simtMemUnits) <- makeWarpPreserver memResps1
 
@@ -254,16 +368,81 @@ makeSIMTMemSubsystem dramResps = mdo
                 }
               )
           }
-    let memReqs1 = mapSource (V.map (fmap prepareReq)) memReqs
+
+    -- Promote byte and halfword loads to aligned word loads.  The
+    -- coalescing unit's strategies are geared towards word accesses;
+    -- after promotion, a warp loading consecutive bytes or halfwords
+    -- is coalesced into the minimum number of beats, with several
+    -- lanes sharing each word.  The original address and access width
+    -- are retained in the request info, so the response mux still
+    -- selects the right bytes.
+    let promoteReq req
+          | SIMTCoalesceSubWordLoads == 0 = req
+          | otherwise =
+              let isSubWordLoad = req.memReqOp .==. memLoadOp .&&.
+                                    req.memReqAccessWidth .<. 2 in
+                req {
+                  memReqAddr = isSubWordLoad ?
+                    (req.memReqAddr .&. inv 3, req.memReqAddr)
+                , memReqAccessWidth = isSubWordLoad ?
+                    (2, req.memReqAccessWidth)
+                }
+
+    -- Optionally swizzle banked SRAM addresses: the bank index is
+    -- XORed with the low bits of the row index.  A warp accessing a
+    -- row or a column of a dense SIMTLanes-wide 2D array then hits
+    -- every bank exactly once, without the need for padding.
+    let swizzleReq req
+          | SIMTSwizzleSRAMBanks == 0 = req
+          | otherwise =
+              req {
+                memReqAddr = isSRAMAddr addr ? (swizzleAddr addr, addr)
+              }
+          where addr = req.memReqAddr
+
+    let memReqs1 = mapSource
+          (V.map (fmap \r -> swizzleReq (promoteReq (prepareReq r))))
+          memReqs
+
+    -- Count lane accesses to banked SRAMs (excluding local fences,
+    -- which are routed to the SRAMs but access no bank).  Lanes
+    -- accessing the same address are served by a single SRAM
+    -- multicast, so the difference between this and the number of
+    -- requests reaching the banks gives the number of multicast hits.
+    sramLaneReqs <- makeStatCounter kernelStart
+    let memReqs2 =
+          memReqs1 {
+            consume = do
+              memReqs1.consume
+              sramLaneReqs.incStatBy $ sum
+                [ zeroExtend (r.valid .&&. isSRAMLaneAccess r.val)
+                | r <- V.toList memReqs1.peek ]
+          }
 
     -- Coalescing unit
-    (memResps, sramReqs, dramReqs) <-
+    (memResps, sramReqs, coalDRAMReqs) <-
       makeSIMTCoalescingUnit isBankedSRAMAccess
-        memReqs1 dramResps sramResps
+        memReqs2 coalDRAMResps sramResps
+
+    -- Optional L1 data cache
+    (l1DRAMReqs, coalDRAMResps, l1Stats) <-
+      if SIMTEnableL1Cache == 1
+        then makeSIMTL1Cache kernelStart enableL1Cache
+               coalDRAMReqs l1DRAMResps
+        else return
+               (coalDRAMReqs, l1DRAMResps, L1CacheStats 0 0)
+
+    -- Merge consecutive DRAM loads into longer bursts
+    (dramReqs, l1DRAMResps, mergerStats) <-
+      makeBurstMerger kernelStart
+        (SIMTEnableBurstMerging == 1)
+        (if SIMTEnableBurstMerging == 1 then SIMTBurstMergeWindow else 0)
+        l1DRAMReqs dramResps
 
     -- Banked SRAMs
     let sramRoute info = info.bankLaneId
-    sramResps <- makeSIMTBankedSRAMs sramRoute sramReqs
+    (sramResps, sramStats) <-
+      makeSIMTBankedSRAMs sramRoute kernelStart sramReqs
 
     -- Process response from memory subsystem
     let processResp resp =
@@ -284,24 +463,48 @@ makeSIMTMemSubsystem dramResps = mdo
       then error "SRAM base address not suitably aligned"
       else return ()
 
-    return (V.fromList simtMemUnits, dramReqs)
+    return
+      ( V.fromList simtMemUnits
+      , dramReqs
+      , SIMTMemStats {
+          memStatsMerger = mergerStats
+        , memStatsSRAMLaneReqs = sramLaneReqs.statValue
+        , memStatsSRAM = sramStats
+        , memStatsL1 = l1Stats
+        }
+      )
 
   where
     -- SRAM-related addresses
     simtStacksStart = 2 ^ (DRAMAddrWidth + DRAMBeatLogBytes) -
-      2 ^ (SIMTLogLanes + SIMTLogWarps + SIMTLogBytesPerStack)
+      2 ^ (SIMTLogCores + SIMTLogLanes + SIMTLogWarps + SIMTLogBytesPerStack)
     sramSize = 2 ^ (SIMTLogLanes + SIMTLogWordsPerSRAMBank+2)
     sramBase = simtStacksStart - sramSize
 
+    -- Does address map to banked SRAMs?
+    isSRAMAddr :: Bit 32 -> Bit 1
+    isSRAMAddr addr =
+      addr .<. fromInteger simtStacksStart .&&.
+        addr .>=. fromInteger sramBase
+
     -- Determine if request maps to banked SRAMs
     -- (Local fence goes to banked SRAMs)
     isBankedSRAMAccess :: MemReq t_id -> Bit 1
     isBankedSRAMAccess req =
       req.memReqOp .==. memLocalFenceOp .||.
         (req.memReqOp .!=. memGlobalFenceOp .&&.
-           addr .<. fromInteger simtStacksStart .&&.
-             addr .>=. fromInteger sramBase)
-      where addr = req.memReqAddr
+           isSRAMAddr (req.memReqAddr))
+
+    -- Banked SRAM access other than a local fence
+    isSRAMLaneAccess :: MemReq t_id -> Bit 1
+    isSRAMLaneAccess req =
+      req.memReqOp .!=. memLocalFenceOp .&&. isBankedSRAMAccess req
+
+    -- XOR bank index (word address bits) with low bits of row index
+    swizzleAddr :: Bit 32 -> Bit 32
+    swizzleAddr addr =
+      addr .^. ((addr .>>. (SIMTLogLanes :: Bit 5)) .&. bankMask)
+      where bankMask = fromInteger ((SIMTLanes - 1) * 4)
 
 -- Coalescing unit (synthesis boundary)
 makeSIMTCoalescingUnit isBankedSRAMAccess =
@@ -309,9 +512,16 @@ makeSIMTCoalescingUnit isBankedSRAMAccess =
     (makeCoalescingUnit @SIMTMemReqId isBankedSRAMAccess)
 
 -- Banked SRAMs (synthesis boundary)
+-- Counts requests (other than local fences) reaching the banks, and
+-- cycles in which a lane's request is held up, whether by a bank
+-- conflict or by response backpressure
 makeSIMTBankedSRAMs route =
-  makeBoundary "SIMTBankedSRAMs"
-    (makeBankedSRAMs @(BankInfo SIMTMemReqId) route)
+  makeBoundary "SIMTBankedSRAMs" \clearStats reqs -> do
+    let notFence req = req.memReqOp .!=. memLocalFenceOp
+    (reqs1, stats) <- makeStreamProbe clearStats notFence (V.toList reqs)
+    resps <- makeBankedSRAMs @(BankInfo SIMTMemReqId) route
+               (V.fromList reqs1)
+    return (resps, stats)
 
 -- SoC top-level module
 -- ====================
@@ -0,0 +1,190 @@
+-- Merge consecutive DRAM load requests into multi-beat bursts
+
+module Memory.BurstMerger where
+
+-- SoC configuration
+#include <Config.h>
+
+-- Blarney imports
+import Blarney
+import Blarney.Queue
+import Blarney.Stream
+import Blarney.SourceSink
+
+-- Pebbles imports
+import Pebbles.Memory.DRAM.Interface
+
+-- SIMTight imports
+import Stats
+
+-- | Burst merger stats
+data BurstMergerStats =
+  BurstMergerStats {
+    mergerLoadReqs :: Bit 32
+    -- ^ Number of DRAM load requests received
+  , mergerLoadBursts :: Bit 32
+    -- ^ Number of DRAM load bursts issued
+  , mergerLoadBeats :: Bit 32
+    -- ^ Number of DRAM load beats requested
+  }
+
+-- | The coalescing unit issues at most one DRAM request per warp
+-- memory access, and a warp's 32 word accesses only span two DRAM
+-- beats.  Streaming kernels therefore issue many short bursts to
+-- consecutive addresses in quick succession (from successive warps
+-- or successive instructions).  This module sits between the
+-- coalescing unit and the DRAM bus, merging such load requests into
+-- longer bursts (up to the max burst size).  A load is held back for
+-- at most the given number of cycles waiting for a mergeable
+-- successor.  Store bursts pass straight through, but only once any
+-- pending load has been issued, so memory ordering is unaffected.
+-- DRAM responses are split back into the original bursts; this
+-- relies on the DRAM returning load responses in order, which is
+-- also assumed by the coalescing unit.
+makeBurstMerger ::
+     Bit 1
+     -- ^ Clear stat counters
+  -> Bool
+     -- ^ Enable merging? (If not, requests and responses pass straight
+     -- through, with no extra register stage, and only stats are
+     -- collected)
+  -> Int
+     -- ^ Max cycles to wait for a mergeable load
+  -> Stream (DRAMReq ())
+     -- ^ DRAM requests from coalescing unit
+  -> Stream (DRAMResp ())
+     -- ^ DRAM responses from DRAM bus
+  -> Module (Stream (DRAMReq ()), Stream (DRAMResp ()), BurstMergerStats)
+     -- ^ DRAM requests to bus, responses to coalescing unit, and stats
+makeBurstMerger clearStats enable window reqs resps
+  | not enable = do
+      -- Stat counters
+      loadReqs <- makeStatCounter clearStats
+      loadBeats <- makeStatCounter clearStats
+
+      -- Observe load requests as they are consumed by the DRAM bus
+      let reqsOut =
+            reqs {
+              consume = do
+                reqs.consume
+                when (inv reqs.peek.dramReqIsStore) do
+                  loadReqs.incStatBy 1
+                  loadBeats.incStatBy (zeroExtend reqs.peek.dramReqBurst)
+            }
+
+      return
+        ( reqsOut
+        , resps
+        , BurstMergerStats {
+            mergerLoadReqs = loadReqs.statValue
+          , mergerLoadBursts = loadReqs.statValue
+          , mergerLoadBeats = loadBeats.statValue
+          }
+        )
+  | otherwise = do
+      -- Pending load request, possibly the result of several merges
+      pending :: Reg (DRAMReq ()) <- makeReg dontCare
+      pendingValid :: Reg (Bit 1) <- makeReg false
+
+      -- Cycles since last merge into pending request
+      waitCount :: Reg (Bit 8) <- makeReg 0
+
+      -- Requests to DRAM bus
+      outQueue :: Queue (DRAMReq ()) <- makeQueue
+
+      -- Burst length of each original load request, in issue order
+      lenQueue :: Queue DRAMBurst <- makeSizedQueue DRAMLogMaxInFlight
+
+      -- Beat count within current original load request
+      beatCount :: Reg DRAMBurst <- makeReg 0
+
+      -- Stat counters
+      loadReqs <- makeStatCounter clearStats
+      loadBursts <- makeStatCounter clearStats
+      loadBeats <- makeStatCounter clearStats
+
+      -- Max burst size
+      let maxBurst = 2 ^ (DRAMBurstWidth - 1)
+
+      -- Can request be merged onto end of pending request?
+      let canMerge req =
+            pendingValid.val .&&. inv req.dramReqIsStore .&&.
+              req.dramReqAddr .==. pending.val.dramReqAddr +
+                zeroExtend pending.val.dramReqBurst .&&.
+                  (zeroExtend pending.val.dramReqBurst +
+                     zeroExtend req.dramReqBurst :: Bit 8)
+                       .<=. fromInteger maxBurst
+
+      always do
+        let req = reqs.peek
+
+        -- Has the pending request waited long enough?
+        let timeout = waitCount.val .>=. fromIntegral window
+
+        -- Merge request into pending request?
+        let merge = reqs.canPeek .&&. canMerge req .&&. inv timeout
+
+        -- Issue pending request?
+        let flush = pendingValid.val .&&. outQueue.notFull .&&.
+              (timeout .||. (reqs.canPeek .&&. inv merge))
+
+        -- Consume a load request?
+        let takeLoad = reqs.canPeek .&&. inv req.dramReqIsStore .&&.
+              lenQueue.notFull .&&.
+                (merge .||. inv pendingValid.val .||. flush)
+
+        -- Pass through a store request?
+        -- (Only once there is no pending load request)
+        let passStore = reqs.canPeek .&&. req.dramReqIsStore .&&.
+              inv pendingValid.val .&&. outQueue.notFull
+
+        when flush do
+          outQueue.enq (pending.val)
+          loadBursts.incStatBy 1
+          loadBeats.incStatBy (zeroExtend pending.val.dramReqBurst)
+
+        when takeLoad do
+          reqs.consume
+          lenQueue.enq (req.dramReqBurst)
+          loadReqs.incStatBy 1
+          waitCount <== 0
+          if merge
+            then do
+              pending <== pending.val {
+                dramReqBurst = pending.val.dramReqBurst + req.dramReqBurst
+              }
+            else do
+              pending <== req
+              pendingValid <== true
+
+        when (inv takeLoad) do
+          if flush
+            then pendingValid <== false
+            else when pendingValid.val do waitCount <== waitCount.val + 1
+
+        when passStore do
+          reqs.consume
+          outQueue.enq req
+
+      -- Split responses back into the original bursts
+      let respsOut =
+            resps {
+              peek = resps.peek { dramRespBurstId = beatCount.val }
+            , consume = do
+                resps.consume
+                if beatCount.val + 1 .==. lenQueue.first
+                  then do
+                    beatCount <== 0
+                    lenQueue.deq
+                  else beatCount <== beatCount.val + 1
+            }
+
+      return
+        ( toStream outQueue
+        , respsOut
+        , BurstMergerStats {
+            mergerLoadReqs = loadReqs.statValue
+          , mergerLoadBursts = loadBursts.statValue
+          , mergerLoadBeats = loadBeats.statValue
+          }
+        )
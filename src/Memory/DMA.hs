@@ -0,0 +1,252 @@
+-- DMA engine for bulk DRAM copies and fills
+
+module Memory.DMA where
+
+-- SoC configuration
+#include <Config.h>
+#include <SoCCtrl.h>
+
+-- Blarney imports
+import Blarney
+import Blarney.Queue
+import Blarney.Stream
+import Blarney.SourceSink
+
+-- Pebbles imports
+import Pebbles.Memory.DRAM.Interface
+
+-- | DMA operation parameters, latched from the SoC control registers
+-- (see SoCCtrl.h) when an operation starts
+data DMAParams =
+  DMAParams {
+    dmaIsFill :: Bit 1
+    -- ^ Fill (rather than copy) operation?
+  , dmaRowBeats :: Bit 32
+    -- ^ Beats per row
+  , dmaSrcStride :: DRAMAddr
+    -- ^ Beats between starts of consecutive source rows
+  , dmaDstStride :: DRAMAddr
+    -- ^ Beats between starts of consecutive destination rows
+  , dmaFillBeat :: DRAMBeat
+    -- ^ Fill word, replicated over a beat
+  }
+  deriving (Generic, Bits)
+
+-- | A burst of up to 2^(DRAMBurstWidth-1) beats to be stored
+data DMABurst =
+  DMABurst {
+    burstAddr :: DRAMAddr
+    -- ^ Destination beat address
+  , burstLen :: DRAMBurst
+    -- ^ Number of beats
+  }
+  deriving (Generic, Bits)
+
+-- | DMA engine, sitting on the DRAM bus and programmed through the
+-- SoC control registers.  An operation moves a 2D region of beats:
+-- a number of rows, each a contiguous run of beats, with independent
+-- source and destination strides (a 1D copy or fill is a single row).
+-- Rows are split into maximum-sized bursts.  For a copy, a load burst
+-- is issued only when there is room for all its beats in the response
+-- buffer, and each response beat is stored to the corresponding
+-- destination burst, so loads and stores overlap.  A fill issues
+-- stores only.  DRAM does not acknowledge stores, so once the last
+-- store has been issued, the engine issues a single-beat load from the
+-- destination and stays busy until its response returns.  DRAM
+-- requests from one client are served in order, so by then every
+-- store has been performed.  Operations are not queued: software
+-- waits for the engine to become idle before starting another.
+makeDMAUnit ::
+     [Bit 32]
+     -- ^ SoC control register values
+  -> Bit 1
+     -- ^ Pulsed when an operation is written to SOC_CTRL_DMA_START
+  -> Stream (DRAMResp ())
+     -- ^ DRAM responses
+  -> Module (Stream (DRAMReq ()), Bit 1)
+     -- ^ DRAM requests, and busy flag
+makeDMAUnit ctrlRegs startPulse resps = do
+  -- Start pulse, delayed until control registers hold new values
+  starting :: Reg (Bit 1) <- makeReg false
+
+  -- Parameters of current operation
+  params :: Reg DMAParams <- makeReg dontCare
+
+  -- Burst generation state
+  generating :: Reg (Bit 1) <- makeReg false
+  rowsLeft :: Reg (Bit 32) <- makeReg dontCare
+  col :: Reg (Bit 32) <- makeReg dontCare
+  rowSrc :: Reg DRAMAddr <- makeReg dontCare
+  rowDst :: Reg DRAMAddr <- makeReg dontCare
+
+  -- Bursts awaiting stores, in order of issue
+  burstQueue :: Queue DMABurst <- makeSizedQueue DRAMLogMaxInFlight
+
+  -- Beat index within burst at head of burst queue
+  storeBeat :: Reg DRAMBurst <- makeReg 0
+
+  -- Load responses awaiting stores
+  respQueue :: Queue (DRAMResp ()) <- makeSizedQueue DRAMLogMaxInFlight
+
+  -- Number of beats loaded (or being loaded) but not yet stored
+  inflight :: Reg (Bit (DRAMLogMaxInFlight+1)) <- makeReg 0
+
+  -- Completion load: waiting to be issued, and awaiting its response
+  fenceIssue :: Reg (Bit 1) <- makeReg false
+  fenceWait :: Reg (Bit 1) <- makeReg false
+  fenceAddr :: Reg DRAMAddr <- makeReg dontCare
+
+  -- DRAM requests
+  outQueue :: Queue (DRAMReq ()) <- makeQueue
+
+  -- Control register values
+  let reg i = ctrlRegs !! i
+  let toBeats :: Bit 32 -> DRAMAddr
+      toBeats a = truncate (slice @31 @DRAMBeatLogBytes a)
+
+  always do
+    -- Start operation
+    -- ---------------
+
+    starting <== startPulse
+    when starting.val do
+      let op = reg SOC_CTRL_DMA_START
+      let rowBeats = zeroExtend (toBeats (reg SOC_CTRL_DMA_ROW_BYTES))
+      let rows = reg SOC_CTRL_DMA_ROWS
+      let fill = reg SOC_CTRL_DMA_FILL
+      params <==
+        DMAParams {
+          dmaIsFill = op .==. DMA_OP_FILL
+        , dmaRowBeats = rowBeats
+        , dmaSrcStride = toBeats (reg SOC_CTRL_DMA_SRC_STRIDE)
+        , dmaDstStride = toBeats (reg SOC_CTRL_DMA_DST_STRIDE)
+        , dmaFillBeat =
+            fromBitList $ concat $
+              replicate DRAMBeatWords (toBitList fill)
+        }
+      let valid = (op .==. DMA_OP_COPY .||. op .==. DMA_OP_FILL) .&&.
+                    rowBeats .!=. 0 .&&. rows .!=. 0
+      generating <== valid
+      fenceIssue <== valid
+      fenceAddr <== toBeats (reg SOC_CTRL_DMA_DST)
+      rowsLeft <== rows
+      col <== 0
+      rowSrc <== toBeats (reg SOC_CTRL_DMA_SRC)
+      rowDst <== toBeats (reg SOC_CTRL_DMA_DST)
+
+    let p = params.val
+
+    -- Store the next beat of the burst at the head of the burst queue?
+    -- (Stores take priority over loads for the request queue, and a
+    -- store burst, once started, is never interleaved with a load)
+    let burst = burstQueue.first
+    let lastBeat = storeBeat.val + 1 .==. burst.burstLen
+    let issueStore = burstQueue.notEmpty .&&. outQueue.notFull .&&.
+                       (p.dmaIsFill .||. respQueue.notEmpty)
+
+    -- Burst generation
+    -- ----------------
+
+    let remaining = p.dmaRowBeats - col.val
+    let len :: DRAMBurst =
+          remaining .>. 2 ^ (DRAMBurstWidth-1) ?
+            (2 ^ (DRAMBurstWidth-1), truncate remaining)
+    let srcAddr = rowSrc.val + truncate col.val
+    let dstAddr = rowDst.val + truncate col.val
+
+    -- Is there room in the response buffer for a load burst?
+    let room = zeroExtend inflight.val + zeroExtend len .<=.
+                 (2 ^ DRAMLogMaxInFlight :: Bit (DRAMLogMaxInFlight+2))
+
+    let issueLoad = generating.val .&&. inv p.dmaIsFill .&&.
+                      burstQueue.notFull .&&. outQueue.notFull .&&.
+                        room .&&. inv issueStore .&&. storeBeat.val .==. 0
+    let issueFill = generating.val .&&. p.dmaIsFill .&&.
+                      burstQueue.notFull
+
+    when (issueLoad .||. issueFill) do
+      burstQueue.enq DMABurst { burstAddr = dstAddr, burstLen = len }
+      if remaining .==. zeroExtend len
+        then do
+          col <== 0
+          rowSrc <== rowSrc.val + p.dmaSrcStride
+          rowDst <== rowDst.val + p.dmaDstStride
+          rowsLeft <== rowsLeft.val - 1
+          when (rowsLeft.val .==. 1) do generating <== false
+        else col <== col.val + zeroExtend len
+
+    when issueLoad do
+      outQueue.enq
+        dontCare {
+          dramReqId = ()
+        , dramReqIsStore = false
+        , dramReqAddr = srcAddr
+        , dramReqBurst = len
+        , dramReqIsFinal = true
+        }
+
+    -- Stores
+    -- ------
+
+    when issueStore do
+      outQueue.enq
+        dontCare {
+          dramReqId = ()
+        , dramReqIsStore = true
+        , dramReqAddr = burst.burstAddr
+        , dramReqData =
+            p.dmaIsFill ? (p.dmaFillBeat, respQueue.first.dramRespData)
+        , dramReqDataTagBits = 0
+        , dramReqByteEn = ones
+        , dramReqBurst = burst.burstLen
+        , dramReqIsFinal = lastBeat
+        }
+      when (inv p.dmaIsFill) do respQueue.deq
+      if lastBeat
+        then do
+          burstQueue.deq
+          storeBeat <== 0
+        else storeBeat <== storeBeat.val + 1
+
+    -- Completion
+    -- ----------
+
+    -- Issue completion load once all stores have been issued
+    -- (No load responses are then outstanding, so the next response
+    -- received is for the completion load)
+    let issueFence = fenceIssue.val .&&. inv starting.val .&&.
+                       inv generating.val .&&. inv burstQueue.notEmpty .&&.
+                         outQueue.notFull
+    when issueFence do
+      outQueue.enq
+        dontCare {
+          dramReqId = ()
+        , dramReqIsStore = false
+        , dramReqAddr = fenceAddr.val
+        , dramReqBurst = 1
+        , dramReqIsFinal = true
+        }
+      fenceIssue <== false
+      fenceWait <== true
+
+    -- Track beats in flight
+    inflight <== inflight.val
+      + (issueLoad ? (zeroExtend len, 0))
+      - ((issueStore .&&. inv p.dmaIsFill) ? (1, 0))
+
+    -- Buffer load responses, and discard the completion response
+    when resps.canPeek do
+      if fenceWait.val
+        then do
+          resps.consume
+          fenceWait <== false
+        else do
+          when respQueue.notFull do
+            respQueue.enq resps.peek
+            resps.consume
+
+  -- Busy until start is seen through and the completion load returns
+  let busy = startPulse .||. starting.val .||. generating.val .||.
+               burstQueue.notEmpty .||. fenceIssue.val .||. fenceWait.val
+
+  return (toStream outQueue, busy)
@@ -0,0 +1,241 @@
+-- SIMT L1 data cache for DRAM loads
+
+module Memory.L1Cache where
+
+-- SoC configuration
+#include <Config.h>
+
+-- Blarney imports
+import Blarney
+import Blarney.Queue
+import Blarney.Stream
+import Blarney.SourceSink
+
+-- Pebbles imports
+import Pebbles.Memory.DRAM.Interface
+
+-- SIMTight imports
+import Stats
+
+-- | Cache line (one DRAM beat per line)
+data L1Line =
+  L1Line {
+    lineValid :: Bit 1
+    -- ^ Is line valid?
+  , lineAddr :: DRAMAddr
+    -- ^ Beat address held by line
+  , lineResp :: DRAMResp ()
+    -- ^ Beat data (including any tag bits), as returned by DRAM
+  }
+  deriving (Generic, Bits)
+
+-- | Load beat awaiting response, in order of issue
+data L1Pending =
+  L1Pending {
+    pendingHit :: Bit 1
+    -- ^ Was the lookup a hit?
+  , pendingBeat :: DRAMBurst
+    -- ^ Beat index within original burst
+  , pendingAddr :: DRAMAddr
+    -- ^ Beat address
+  , pendingGen :: Bit 16
+    -- ^ Invalidation generation at time of lookup
+  , pendingResp :: DRAMResp ()
+    -- ^ Response data, in case of a hit
+  }
+  deriving (Generic, Bits)
+
+-- | L1 cache stats
+data L1CacheStats =
+  L1CacheStats {
+    l1Hits :: Bit 32
+    -- ^ Number of beats loaded from cache
+  , l1Misses :: Bit 32
+    -- ^ Number of beats loaded from DRAM
+  }
+
+-- | Direct-mapped, write-through cache of DRAM beats, sitting
+-- between the SIMT coalescing unit and DRAM.  Load bursts are looked
+-- up one beat at a time; missing beats are fetched from DRAM as
+-- single-beat loads (to be re-merged into bursts downstream) and
+-- responses are returned in order.  Stores pass through, invalidating
+-- any cached beats they write.  A fill is dropped if any invalidation
+-- occurred since its lookup, so lines never hold stale data.  The
+-- whole cache is invalidated at the start of each kernel that uses
+-- it, since the CPU may have written DRAM in the meantime.  When
+-- disabled at runtime, every lookup misses and nothing is filled.
+makeSIMTL1Cache ::
+     Bit 1
+     -- ^ Kernel start pulse (invalidates cache, clears stats)
+  -> Bit 1
+     -- ^ Is cache enabled (runtime setting, stable from kernel start)?
+  -> Stream (DRAMReq ())
+     -- ^ DRAM requests from coalescing unit
+  -> Stream (DRAMResp ())
+     -- ^ DRAM responses
+  -> Module (Stream (DRAMReq ()), Stream (DRAMResp ()), L1CacheStats)
+     -- ^ DRAM requests, responses to coalescing unit, and stats
+makeSIMTL1Cache start enable reqs resps = do
+  -- Cache lines
+  cacheLines :: RAM (Bit SIMTL1CacheLogBeats) L1Line <- makeDualRAM
+
+  -- Invalidation sweep (also performed after reset)
+  sweeping :: Reg (Bit 1) <- makeReg true
+  sweepIdx :: Reg (Bit SIMTL1CacheLogBeats) <- makeReg 0
+
+  -- Invalidation generation, incremented on every invalidation
+  gen :: Reg (Bit 16) <- makeReg 0
+
+  -- Beat index within current request burst
+  reqBeat :: Reg DRAMBurst <- makeReg 0
+
+  -- Lookup stage
+  lookupValid :: Reg (Bit 1) <- makeReg false
+  lookupReq :: Reg (DRAMReq ()) <- makeReg dontCare
+  lookupBeat :: Reg DRAMBurst <- makeReg dontCare
+
+  -- Beats awaiting response, in order
+  pendingQueue :: Queue L1Pending <- makeSizedQueue DRAMLogMaxInFlight
+
+  -- Requests to DRAM (misses and stores)
+  outQueue :: Queue (DRAMReq ()) <- makeQueue
+
+  -- Fill request from response side
+  fillWire :: Wire (Bit SIMTL1CacheLogBeats, L1Line) <- makeWire dontCare
+
+  -- Stat counters
+  hits <- makeStatCounter start
+  misses <- makeStatCounter start
+
+  -- Line index for beat address
+  let index :: DRAMAddr -> Bit SIMTL1CacheLogBeats
+      index = truncate
+
+  -- Contents of invalidated line
+  let invalidLine =
+        L1Line {
+          lineValid = false
+        , lineAddr = dontCare
+        , lineResp = dontCare
+        }
+
+  always do
+    -- Lookup stage
+    -- ------------
+
+    let line = cacheLines.out
+    let beatAddr = lookupReq.val.dramReqAddr + zeroExtend lookupBeat.val
+    let hit = enable .&&. line.lineValid .&&. line.lineAddr .==. beatAddr
+    let advance = lookupValid.val .&&. pendingQueue.notFull .&&.
+                    (hit .||. outQueue.notFull)
+
+    when advance do
+      pendingQueue.enq
+        L1Pending {
+          pendingHit = hit
+        , pendingBeat = lookupBeat.val
+        , pendingAddr = beatAddr
+        , pendingGen = gen.val
+        , pendingResp = line.lineResp
+        }
+      if hit
+        then hits.incStatBy 1
+        else do
+          misses.incStatBy 1
+          outQueue.enq lookupReq.val {
+              dramReqAddr = beatAddr
+            , dramReqBurst = 1
+            , dramReqIsFinal = true
+            }
+
+    -- Request stage
+    -- -------------
+
+    let req = reqs.peek
+    let reqAddr = req.dramReqAddr + zeroExtend reqBeat.val
+    let lastBeat = reqBeat.val + 1 .==. req.dramReqBurst
+
+    -- Load: issue lookup for next beat of burst
+    let issueLoad = reqs.canPeek .&&. inv sweeping.val .&&.
+          inv req.dramReqIsStore .&&. (inv lookupValid.val .||. advance)
+
+    -- Store: pass through once all earlier loads have been looked up,
+    -- invalidating the beat being written
+    let issueStore = reqs.canPeek .&&. inv sweeping.val .&&.
+          req.dramReqIsStore .&&. inv lookupValid.val .&&. outQueue.notFull
+
+    when issueLoad do
+      cacheLines.load (index reqAddr)
+      lookupReq <== req
+      lookupBeat <== reqBeat.val
+
+    when (advance .&&. inv issueLoad) do
+      lookupValid <== false
+    when issueLoad do
+      lookupValid <== true
+
+    when issueStore do
+      outQueue.enq req
+      gen <== gen.val + 1
+
+    when (issueLoad .||. issueStore) do
+      if lastBeat .||. (req.dramReqIsStore .&&. req.dramReqIsFinal)
+        then do
+          reqs.consume
+          reqBeat <== 0
+        else reqBeat <== reqBeat.val + 1
+
+    -- Line updates, in priority order
+    -- -------------------------------
+
+    if sweeping.val
+      then do
+        cacheLines.store (sweepIdx.val) invalidLine
+        sweepIdx <== sweepIdx.val + 1
+        gen <== gen.val + 1
+        when (sweepIdx.val .==. ones) do sweeping <== false
+      else do
+        if issueStore
+          then cacheLines.store (index reqAddr) invalidLine
+          else when fillWire.active do
+                 cacheLines.store (fillWire.val.fst) (fillWire.val.snd)
+
+    -- Invalidate at kernel start, unless the cache is disabled for the
+    -- kernel (no lines are filled while disabled, and the next kernel
+    -- to enable the cache sweeps anyway)
+    when (start .&&. enable) do
+      sweeping <== true
+      sweepIdx <== 0
+
+  -- Responses: hits come from the pending queue, misses from DRAM
+  let head = pendingQueue.first
+  let respsOut =
+        Source {
+          canPeek = pendingQueue.notEmpty .&&.
+                      (head.pendingHit .||. resps.canPeek)
+        , peek = (head.pendingHit ? (head.pendingResp, resps.peek))
+                   { dramRespBurstId = head.pendingBeat }
+        , consume = do
+            pendingQueue.deq
+            when (inv head.pendingHit) do
+              resps.consume
+              -- Fill, unless line may have been invalidated since lookup
+              when (enable .&&. head.pendingGen .==. gen.val) do
+                fillWire <==
+                  ( index head.pendingAddr
+                  , L1Line {
+                      lineValid = true
+                    , lineAddr = head.pendingAddr
+                    , lineResp = resps.peek
+                    }
+                  )
+        }
+
+  return
+    ( toStream outQueue
+    , respsOut
+    , L1CacheStats {
+        l1Hits = hits.statValue
+      , l1Misses = misses.statValue
+      }
+    )
@@ -0,0 +1,140 @@
+-- SoC-level stat counters
+
+module Stats where
+
+-- SoC configuration
+#include <Config.h>
+#include <SoCStats.h>
+
+-- Blarney imports
+import Blarney
+import Blarney.Queue
+import Blarney.Stream
+import Blarney.PulseWire
+import Blarney.SourceSink
+import Blarney.Interconnect
+
+-- Pebbles imports
+import Pebbles.Pipeline.SIMT.Management
+
+-- Stat counters
+-- =============
+
+-- | A stat counter, tagged with its id (see SoCStats.h)
+type SoCStat = (Integer, Bit 32)
+
+-- | Stat counter, cleared at the start of each kernel
+data StatCounter =
+  StatCounter {
+    incStatBy :: Bit 32 -> Action ()
+    -- ^ Increment counter (at most once per cycle)
+  , statValue :: Bit 32
+    -- ^ Current value of counter
+  }
+
+-- | Create stat counter, given pulse that clears it.  If stat
+-- counters are disabled in the config, the counter is always zero.
+makeStatCounter :: Bit 1 -> Module StatCounter
+makeStatCounter clear
+  | SIMTEnableStatCounters == 0 =
+      return StatCounter { incStatBy = \_ -> return (), statValue = 0 }
+  | otherwise = do
+      count :: Reg (Bit 32) <- makeReg 0
+      incWire :: Wire (Bit 32) <- makeWire 0
+
+      always do
+        count <== clear ? (0, count.val + incWire.val)
+
+      return
+        StatCounter {
+          incStatBy = \n -> incWire <== n
+        , statValue = count.val
+        }
+
+-- | Stats for a group of streams
+data StreamStats =
+  StreamStats {
+    streamItems :: Bit 32
+    -- ^ Number of counted items consumed, over all streams
+  , streamStallCycles :: Bit 32
+    -- ^ Cycles in which some stream had an item that was not consumed
+    -- (for whatever reason, e.g. contention or backpressure)
+  }
+  deriving (Generic, Interface)
+
+-- | Observe consumption of items from a group of streams, counting
+-- only items satisfying the given predicate
+makeStreamProbe :: Bit 1 -> (a -> Bit 1) -> [Stream a]
+                -> Module ([Stream a], StreamStats)
+makeStreamProbe clear counted streams = do
+  -- Pulsed when an item is consumed from each stream
+  pulses <- mapM (const makePulseWire) streams
+
+  -- Counters
+  items <- makeStatCounter clear
+  stalls <- makeStatCounter clear
+
+  always do
+    items.incStatBy $ sum [ zeroExtend (p.val .&&. counted s.peek)
+                          | (s, p) <- zip streams pulses ]
+    when (orList [ s.canPeek .&&. inv p.val
+                 | (s, p) <- zip streams pulses ]) do
+      stalls.incStatBy 1
+
+  return
+    ( [ s { consume = do s.consume; p.pulse }
+      | (s, p) <- zip streams pulses ]
+    , StreamStats {
+        streamItems = items.statValue
+      , streamStallCycles = stalls.statValue
+      }
+    )
+
+-- Stats unit
+-- ==========
+
+-- | Intercept SIMT management requests for SoC-level stat counters,
+-- which live outside the SIMT pipeline (e.g. in the memory subsystem).
+-- All other requests are forwarded to the SIMT core.  Also returns a
+-- pulse, raised when a kernel is started, which clears the counters.
+makeSoCStatsUnit ::
+     -- | SoC-level stat counters
+     [SoCStat]
+     -- | Management requests from CPU
+  -> Stream SIMTReq
+     -- | Management responses from SIMT core
+  -> Stream SIMTResp
+     -- | Management requests to SIMT core, responses to CPU,
+     -- and clear pulse for stat counters
+  -> Module (Stream SIMTReq, Stream SIMTResp, Bit 1)
+makeSoCStatsUnit stats reqs resps = do
+  -- Responses to SoC-level stat requests
+  respQueue <- makeQueue
+
+  -- Pulsed when kernel start request is forwarded
+  startPulse <- makePulseWire
+
+  -- Is given request for a SoC-level stat counter?
+  let isSoCStat req =
+        req.simtReqCmd .==. simtCmd_AskStats .&&.
+          req.simtReqData .>=. STAT_SOC_BASE
+
+  always do
+    when (reqs.canPeek .&&. isSoCStat (reqs.peek)
+                       .&&. respQueue.notFull) do
+      reqs.consume
+      respQueue.enq $ select
+        [ (reqs.peek.simtReqData .==. fromInteger id, val)
+        | (id, val) <- stats ]
+
+  -- Forward requests to SIMT core, except those served here
+  let reqsToCore =
+        reqs {
+          canPeek = reqs.canPeek .&&. inv (isSoCStat (reqs.peek))
+        , consume = do
+            reqs.consume
+            when (reqs.peek.simtReqCmd .==. simtCmd_StartPipeline) do
+              startPulse.pulse
+        }
+
+  return (reqsToCore, resps `mergeTwo` toStream respQueue, startPulse.val)
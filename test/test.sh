@@ -9,6 +9,16 @@ APPS=(
   Transpose
   MatVecMul
   MatMul
+  ByteStream
+  DotProd8
+  PopCount
+  ModHash
+  FastDiv
+  SAXPY
+  SGEMM
+  SoftFloat
+  FixedMath
+  IGEMM
 )
 
 RED='\033[0;31m'
@@ -81,6 +91,12 @@ assert() {
   echo
 }
 
+# Sum given (hex) stat over all kernel invocations in log
+sumStat() {
+  python -c "import sys; print('%x' % sum(int(x, 16) for x in sys.argv[1:]))" \
+    $(grep "^$1:" $2 | cut -d' ' -f2)
+}
+
 # Kill simulator if running
 cleanup() {
   if [ "$SIM_PID" != "" ]; then
@@ -208,12 +224,15 @@ if [ "$TestFPGA" != "" ] ; then
     tmpLog=$(mktemp -t pebbles-$APP-XXXX.log)
     $(cd ../apps/$APP && ./Run > $tmpLog)
     OK=$(grep "Self test: PASSED" $tmpLog)
-    CYCLES=$(grep Cycles: $tmpLog | cut -d' ' -f2)
-    INSTRS=$(grep Instrs: $tmpLog | cut -d' ' -f2)
+    CYCLES=$(sumStat Cycles $tmpLog)
+    INSTRS=$(sumStat Instrs $tmpLog)
+    BURSTS=$(sumStat DRAMLoadBursts $tmpLog)
+    BEATS=$(sumStat DRAMLoadBeats $tmpLog)
     DCYCLES=$(python -c "print('%d' % (0x${CYCLES}))")
     IPC=$(python -c "print('%.2f' % (float(0x${INSTRS}) / 0x${CYCLES}))")
+    BURST=$(python -c "print('%.2f' % (float(0x${BEATS}) / max(1, 0x${BURSTS})))")
     test "$OK" != ""
-    assert $? "" " [IPC=$IPC,Cycles=$DCYCLES]"
+    assert $? "" " [IPC=$IPC,Cycles=$DCYCLES,AvgBurst=$BURST]"
   done
 fi
 